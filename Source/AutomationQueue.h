@@ -0,0 +1,140 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+
+//==============================================================================
+// Timestamped parameter changes, placed inside the block instead of at its start.
+// Changes made off the audio thread (the editor, a host's UI or automation
+// thread) are queued with the time they arrived. At the start of each block the
+// audio thread drains the queue and places every change at the sample offset its
+// age corresponds to, counted back from the end of the block, and the block is
+// then processed in pieces split at those offsets.
+//
+// This is a best effort, for GUI changes only. The wall clock says when a change
+// arrived, not which sample it belongs to, so placement is neither deterministic
+// nor sample accurate; it only spreads a drag across the block instead of
+// stepping at its start. Host automation gets nothing from it: JUCE's wrappers
+// apply a host's parameter changes on the audio thread just before processBlock
+// and pass on no sample offsets for them, so those are never queued and apply
+// from the first sample.
+//
+// Offsets are rounded down to a grid of minimumSplitSamples and kept at least
+// that far from the end of the block, so however dense the changes, no piece
+// they cut is shorter than that.
+class AutomationQueue
+{
+public:
+    static constexpr int capacity = 256;           // changes between two blocks
+    static constexpr int minimumSplitSamples = 16; // divides internalBlockSize
+    static constexpr int maxParameters = 32;
+
+    // Any thread but the audio thread. Producers serialise on a spin lock among
+    // themselves; the audio thread never takes it. A full queue drops the change,
+    // and the next block picks the value up at its start instead.
+    void push(int parameterIndex, float value) noexcept
+    {
+        jassert(juce::isPositiveAndBelow(parameterIndex, maxParameters));
+        const auto now = juce::Time::getHighResolutionTicks();
+        const juce::SpinLock::ScopedLockType sl(writeLock);
+
+        int start1, size1, start2, size2;
+        fifo.prepareToWrite(1, start1, size1, start2, size2);
+
+        if (size1 > 0)
+            queue[(size_t)start1] = { parameterIndex, value, now, 0 };
+
+        fifo.finishedWrite(size1);
+    }
+
+    // Audio thread, at block start. Untimed (offline renders, where the wall clock
+    // says nothing about the timeline) every change lands on the first sample.
+    void beginBlock(int numSamples, double sampleRate, bool timed) noexcept
+    {
+        int start1, size1, start2, size2;
+        fifo.prepareToRead(capacity, start1, size1, start2, size2);
+
+        std::copy_n(queue.begin() + start1, size1, events.begin());
+        std::copy_n(queue.begin() + start2, size2, events.begin() + size1);
+
+        fifo.finishedRead(size1 + size2);
+
+        numEvents = size1 + size2;
+        nextEvent = 0;
+        automatedMask = 0;
+
+        const auto now = juce::Time::getHighResolutionTicks();
+        const auto samplesPerTick = sampleRate / (double)juce::Time::getHighResolutionTicksPerSecond();
+
+        for (int i = 0; i < numEvents; ++i)
+        {
+            auto& event = events[(size_t)i];
+            int offset = 0;
+
+            if (timed && numSamples > 0)
+            {
+                const auto samplesAgo = (double)(now - event.ticks) * samplesPerTick;
+                const auto lastOffset = juce::jmax(0, numSamples - minimumSplitSamples);
+                offset = juce::jlimit(0, lastOffset, numSamples - (int)samplesAgo);
+                offset -= offset % minimumSplitSamples;
+            }
+
+            event.offset = offset;
+            automatedMask |= 1u << event.parameterIndex;
+        }
+
+        // Each producer queues in time order, but two can interleave. An insertion
+        // sort keeps equal offsets in arrival order and allocates nothing.
+        for (int i = 1; i < numEvents; ++i)
+            for (int j = i; j > 0 && events[(size_t)j - 1].offset > events[(size_t)j].offset; --j)
+                std::swap(events[(size_t)j - 1], events[(size_t)j]);
+    }
+
+    // Whether a parameter changes anywhere in this block. Until its first change
+    // is due it keeps the value it ended the last block on.
+    bool isAutomated(int parameterIndex) const noexcept { return ((automatedMask >> parameterIndex) & 1u) != 0; }
+
+    // Hands every change due by position to apply(index, value), oldest first, and
+    // returns whether there were any
+    template <typename Apply>
+    bool applyUpTo(int position, Apply&& apply)
+    {
+        const int first = nextEvent;
+        for (; nextEvent < numEvents && events[(size_t)nextEvent].offset <= position; ++nextEvent)
+            apply(events[(size_t)nextEvent].parameterIndex, events[(size_t)nextEvent].value);
+
+        return nextEvent != first;
+    }
+
+    // Where the piece starting after the changes already applied has to end:
+    // the next change, or limit
+    int getNextSplit(int limit) const noexcept
+    {
+        return nextEvent < numEvents ? juce::jmin(limit, events[(size_t)nextEvent].offset) : limit;
+    }
+
+    // Forgets what is left of this block, for a preset that replaces everything
+    void skipBlock() noexcept
+    {
+        nextEvent = numEvents;
+        automatedMask = 0;
+    }
+
+private:
+    struct Event
+    {
+        int parameterIndex = 0;
+        float value = 0.0f;
+        juce::int64 ticks = 0;
+        int offset = 0; // into the current block, once placed
+    };
+
+    juce::SpinLock writeLock;
+    juce::AbstractFifo fifo{ capacity };
+    std::array<Event, capacity> queue{};
+
+    // This block's changes by offset; audio thread only
+    std::array<Event, capacity> events{};
+    int numEvents = 0, nextEvent = 0;
+    juce::uint32 automatedMask = 0;
+};
@@ -0,0 +1,81 @@
+#include "ChannelWorkerPool.h"
+
+#if JUCE_WINDOWS
+ #ifndef NOMINMAX
+  #define NOMINMAX
+ #endif
+ #ifndef WIN32_LEAN_AND_MEAN
+  #define WIN32_LEAN_AND_MEAN
+ #endif
+ #include <windows.h>
+#elif JUCE_MAC || JUCE_IOS
+ #include <dispatch/dispatch.h>
+#else
+ #include <semaphore.h>
+ #include <cerrno>
+#endif
+
+//==============================================================================
+// Unnamed POSIX semaphores don't exist on Apple platforms, so those use dispatch's
+#if JUCE_WINDOWS
+
+struct ChannelWorkerPool::WakeSignal::Native
+{
+    HANDLE handle = CreateSemaphoreW(nullptr, 0, LONG_MAX, nullptr);
+    ~Native() { CloseHandle(handle); }
+
+    void post(int count) noexcept { ReleaseSemaphore(handle, count, nullptr); }
+    void wait() noexcept { WaitForSingleObject(handle, INFINITE); }
+    bool tryWait() noexcept { return WaitForSingleObject(handle, 0) == WAIT_OBJECT_0; }
+};
+
+#elif JUCE_MAC || JUCE_IOS
+
+struct ChannelWorkerPool::WakeSignal::Native
+{
+    dispatch_semaphore_t semaphore = dispatch_semaphore_create(0);
+    ~Native() { dispatch_release(semaphore); }
+
+    void post(int count) noexcept
+    {
+        for (int i = 0; i < count; ++i)
+            dispatch_semaphore_signal(semaphore);
+    }
+
+    void wait() noexcept { dispatch_semaphore_wait(semaphore, DISPATCH_TIME_FOREVER); }
+    bool tryWait() noexcept { return dispatch_semaphore_wait(semaphore, DISPATCH_TIME_NOW) == 0; }
+};
+
+#else
+
+struct ChannelWorkerPool::WakeSignal::Native
+{
+    sem_t semaphore;
+
+    Native() { sem_init(&semaphore, 0, 0); }
+    ~Native() { sem_destroy(&semaphore); }
+
+    void post(int count) noexcept
+    {
+        for (int i = 0; i < count; ++i)
+            sem_post(&semaphore);
+    }
+
+    void wait() noexcept
+    {
+        while (sem_wait(&semaphore) != 0 && errno == EINTR)
+        {
+        }
+    }
+
+    bool tryWait() noexcept { return sem_trywait(&semaphore) == 0; }
+};
+
+#endif
+
+ChannelWorkerPool::WakeSignal::WakeSignal() : native(std::make_unique<Native>()) {}
+ChannelWorkerPool::WakeSignal::~WakeSignal() = default;
+
+void ChannelWorkerPool::WakeSignal::post(int count) noexcept { native->post(count); }
+void ChannelWorkerPool::WakeSignal::wait() noexcept { native->wait(); }
+bool ChannelWorkerPool::WakeSignal::tryWait() noexcept { return native->tryWait(); }
@@ -0,0 +1,280 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include "Trace.h"
+
+#if JUCE_INTEL
+ #include <immintrin.h>
+#endif
+
+//==============================================================================
+// One process-wide pool that spreads a block's channel groups over a thread per
+// spare core. Instances share it through juce::SharedResourcePointer, and it only
+// has threads while at least one of them has asked for parallel processing.
+//
+// The calling audio thread takes jobs as well and never locks or waits: jobs are
+// claimed from one atomic word holding a generation and the next index, and the
+// caller spins on the completion count until the slowest job is done. Workers
+// that found nothing for a short spin sleep on a semaphore, and run() posts it
+// for as many of them as it has jobs to spare; a post never blocks. A worker
+// that wakes late finds its job already taken by the audio thread, so a slow
+// wake costs parallelism, never time.
+//
+// Only one audio thread has the workers at a time. Another instance arriving
+// while they are busy runs its own groups inline rather than queue behind it.
+class ChannelWorkerPool
+{
+public:
+    ChannelWorkerPool() = default;
+    ~ChannelWorkerPool() { stopWorkers(); }
+
+    // Message thread. The workers start with the first instance that wants them
+    // and stop again once none does.
+    void addUser()
+    {
+        const juce::ScopedLock sl(userLock);
+        if (numUsers++ == 0)
+            startWorkers();
+    }
+
+    void removeUser()
+    {
+        const juce::ScopedLock sl(userLock);
+        jassert(numUsers > 0);
+        if (--numUsers == 0)
+            stopWorkers();
+    }
+
+    // Calls job(index) once for every index in [0, numJobs), spread over the
+    // workers and the calling thread, and returns when all of them have finished
+    template <typename Job>
+    void run(int numJobs, Job& job) noexcept
+    {
+        jassert(numJobs >= 0 && (juce::uint64)numJobs < indexMask);
+
+        if (numJobs <= 1 || busy.exchange(true, std::memory_order_acquire))
+        {
+            for (int i = 0; i < numJobs; ++i)
+                job(i);
+
+            return;
+        }
+
+        // Nothing can be claimed while the job is swapped in; a worker still
+        // looking at the previous generation fails its claim on the new word
+        const auto generation = (work.load() >> 32) + 1;
+        work.store((generation << 32) | indexMask);
+
+        context.store(&job);
+        invoke.store(&invokeJob<Job>);
+        totalJobs.store(numJobs);
+        completedJobs.store(0);
+
+        work.store(generation << 32);
+        wakeSleepers(numJobs - 1);
+
+        while (runNextJob())
+        {
+        }
+
+        while (completedJobs.load() < numJobs)
+            pause();
+
+        busy.store(false, std::memory_order_release);
+    }
+
+    // Pause-spins an idle worker keeps watching for work before it sleeps
+    static constexpr int idleSpins = 1 << 11;
+
+private:
+    //==============================================================================
+    // Counting semaphore on the platform's own primitive. post() never blocks.
+    class WakeSignal
+    {
+    public:
+        WakeSignal();
+        ~WakeSignal();
+
+        void post(int count) noexcept;
+        void wait() noexcept;
+        bool tryWait() noexcept;
+
+    private:
+        struct Native;
+        std::unique_ptr<Native> native;
+
+        JUCE_DECLARE_NON_COPYABLE(WakeSignal)
+    };
+
+    struct Worker : public juce::Thread
+    {
+        Worker(ChannelWorkerPool& p, int index)
+            : juce::Thread("DREKAVAC worker " + juce::String(index + 1)), pool(p)
+        {
+        }
+
+        void run() override
+        {
+            // Same floating point mode the audio thread runs the chain with
+            juce::ScopedNoDenormals noDenormals;
+            DREKAVAC_TRACE_THREAD_NAME(getThreadName());
+
+            auto seenGeneration = pool.work.load() >> 32;
+            int spins = 0;
+
+            // A word with the index all ones is a generation still being set up
+            auto hasNewWork = [this, &seenGeneration](juce::uint64 word)
+                {
+                    return (word >> 32) != seenGeneration && (word & indexMask) != indexMask;
+                };
+
+            while (!threadShouldExit())
+            {
+                const auto word = pool.work.load();
+                if (hasNewWork(word))
+                {
+                    seenGeneration = word >> 32;
+
+                    while (pool.runNextJob())
+                    {
+                    }
+
+                    spins = 0;
+                }
+                else if (spins < idleSpins)
+                {
+                    ++spins;
+                    pause();
+                }
+                else
+                {
+                    // Counted as asleep before the second look, so a generation
+                    // published in between is either seen here or posted for
+                    pool.numSleeping.fetch_add(1);
+
+                    if (hasNewWork(pool.work.load()))
+                        pool.numSleeping.fetch_sub(1); // a post already made for it only wakes someone early
+                    else
+                        pool.wakeSignal.wait();
+
+                    spins = 0;
+                }
+            }
+        }
+
+        ChannelWorkerPool& pool;
+    };
+
+    // One spin-wait step, easing off the core without leaving user space
+    static void pause() noexcept
+    {
+       #if JUCE_INTEL
+        _mm_pause();
+       #elif JUCE_ARM && JUCE_MSVC
+        __yield();
+       #elif JUCE_ARM
+        __asm__ __volatile__("yield");
+       #endif
+    }
+
+    template <typename Job>
+    static void invokeJob(void* job, int index) { (*static_cast<Job*>(job))(index); }
+
+    // Claims and runs one job of the current generation, false once none are left
+    bool runNextJob() noexcept
+    {
+        for (;;)
+        {
+            auto claim = work.load();
+            auto* jobContext = context.load();
+            auto* jobFunction = invoke.load();
+            const auto index = claim & indexMask;
+
+            if (index >= (juce::uint64)totalJobs.load())
+                return false;
+
+            // Only succeeds while the word still belongs to the generation the
+            // context above was read for
+            if (work.compare_exchange_weak(claim, claim + 1))
+            {
+                jobFunction(jobContext, (int)index);
+                completedJobs.fetch_add(1);
+                return true;
+            }
+        }
+    }
+
+    // Takes up to count sleepers off the tally and posts one wake for each
+    void wakeSleepers(int count) noexcept
+    {
+        auto sleeping = numSleeping.load();
+        int taken = 0;
+
+        do
+        {
+            taken = juce::jmin(sleeping, count);
+            if (taken <= 0)
+                return;
+        }
+        while (!numSleeping.compare_exchange_weak(sleeping, sleeping - taken));
+
+        wakeSignal.post(taken);
+    }
+
+    // One worker per core beyond the audio thread's own
+    void startWorkers()
+    {
+        const int numWorkers = juce::SystemStats::getNumCpus() - 1;
+
+        for (int i = 0; i < numWorkers; ++i)
+        {
+            auto worker = std::make_unique<Worker>(*this, i);
+
+            if (!worker->startRealtimeThread(juce::Thread::RealtimeOptions{}))
+                worker->startThread(juce::Thread::Priority::highest);
+
+            workers.push_back(std::move(worker));
+        }
+    }
+
+    void stopWorkers()
+    {
+        for (auto& worker : workers)
+            worker->signalThreadShouldExit();
+
+        wakeSignal.post((int)workers.size());
+
+        for (auto& worker : workers)
+            worker->stopThread(1000);
+
+        workers.clear();
+
+        // The next set starts from an empty tally, without posts left over
+        numSleeping.store(0);
+        while (wakeSignal.tryWait())
+        {
+        }
+    }
+
+    static constexpr juce::uint64 indexMask = 0xffffffffu;
+
+    // Generation in the high half, next job index in the low half
+    std::atomic<juce::uint64> work{ indexMask };
+    std::atomic<void*> context{ nullptr };
+    std::atomic<void (*)(void*, int)> invoke{ nullptr };
+    std::atomic<int> totalJobs{ 0 }, completedJobs{ 0 };
+    std::atomic<bool> busy{ false };
+
+    // Workers asleep on wakeSignal, as far as run() knows
+    std::atomic<int> numSleeping{ 0 };
+    WakeSignal wakeSignal;
+
+    juce::CriticalSection userLock;
+    int numUsers = 0;
+    std::vector<std::unique_ptr<Worker>> workers;
+
+    JUCE_DECLARE_NON_COPYABLE(ChannelWorkerPool)
+};
@@ -0,0 +1,325 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include "PluginProcessor.h"
+
+//==============================================================================
+// Low-latency live mode for the standalone. Switching it on puts the processor
+// in its zero-latency setting and starts the device at its smallest buffer. A
+// size that misses a deadline during its probe is given up for the next larger
+// one; the first size that gets through a probe clean is kept, and from then on
+// the buffer is left alone, since every change restarts the device mid-set.
+//
+// Misses are counted twice: blocks the processor's load measurer saw overrun
+// their period, and xruns the driver itself reports, where it can.
+//
+// The round trip the drivers report can be checked against a measured one:
+// measureRoundTrip() plays a single click and times its return through an
+// output patched back to an input.
+class LiveModeController : private juce::Timer
+{
+public:
+    struct Readout
+    {
+        int bufferSize = 0;
+        double sampleRate = 0.0;
+
+        // Driver input and output latency plus the plugin's, as reported. Left
+        // out: the fraction of a sample the ADAA stages add, under one with live
+        // mode's settings and half more with Output Clip ADAA on, which the
+        // plugin cannot report in whole samples.
+        int roundTripSamples = 0;
+        double roundTripMilliseconds = 0.0;
+
+        // The click's trip through the device and the cable plus the plugin's
+        // latency: 0 until measured at the current buffer size, -1 if the click
+        // never came back
+        int measuredRoundTripSamples = 0;
+        double measuredRoundTripMilliseconds = 0.0;
+        bool measuring = false;
+
+        // Running totals since live mode was switched on
+        int deadlineMisses = 0;
+        int deviceXruns = -1; // -1 while the driver reports none
+
+        bool settled = false;
+    };
+
+    // A size is kept once it runs this long without a miss
+    static constexpr double probeSeconds = 5.0;
+
+    // Polls straight after a restart only take new baselines
+    static constexpr double restartGraceSeconds = 0.5;
+
+    static constexpr int minimumBufferSize = 16;
+
+    LiveModeController(DREKAVACAudioProcessor& p, juce::AudioDeviceManager& manager)
+        : processor(p), deviceManager(manager)
+    {
+    }
+
+    ~LiveModeController() override
+    {
+        onUpdate = nullptr;
+        setActive(false);
+    }
+
+    void setActive(bool shouldBeActive)
+    {
+        if (shouldBeActive == active)
+            return;
+
+        active = shouldBeActive;
+        processor.setLiveMode(active);
+
+        if (active)
+        {
+            readout = {};
+            lastDeadlineMisses = lastDeviceXruns = 0;
+            bufferSizeBeforeLiveMode = deviceManager.getAudioDeviceSetup().bufferSize;
+
+            candidateSizes.clear();
+            if (auto* device = deviceManager.getCurrentAudioDevice())
+                for (auto size : device->getAvailableBufferSizes())
+                    if (size >= minimumBufferSize)
+                        candidateSizes.addIfNotAlreadyThere(size);
+
+            candidateSizes.sort();
+            candidateIndex = 0;
+
+            if (candidateSizes.isEmpty())
+                readout.settled = true;
+            else
+                applyBufferSize(candidateSizes.getFirst());
+
+            startTimer(250);
+        }
+        else
+        {
+            stopTimer();
+            stopProbe();
+
+            if (bufferSizeBeforeLiveMode > 0)
+                applyBufferSize(bufferSizeBeforeLiveMode);
+        }
+
+        if (onUpdate)
+            onUpdate();
+    }
+
+    bool isActive() const noexcept { return active; }
+
+    // Starts a loopback measurement; the result shows up in the readout
+    void measureRoundTrip()
+    {
+        if (!active || probe != nullptr)
+            return;
+
+        probe = std::make_unique<LoopbackProbe>();
+        deviceManager.addAudioCallback(probe.get());
+
+        readout.measuring = true;
+        if (onUpdate)
+            onUpdate();
+    }
+
+    const Readout& getReadout() const noexcept { return readout; }
+
+    // Called on the message thread after every poll
+    std::function<void()> onUpdate;
+
+private:
+    //==============================================================================
+    // A second device callback next to the plugin's, so the click skips the
+    // plugin and the result is the device's own round trip. It listens first to
+    // learn the noise floor, sends one click on every output, and takes the first
+    // input sample well above that floor as its return. The device mixes its
+    // callbacks' outputs, so this one writes silence everywhere else.
+    class LoopbackProbe : public juce::AudioIODeviceCallback
+    {
+    public:
+        static constexpr double listenSeconds = 0.1, timeoutSeconds = 1.0;
+        static constexpr float clickLevel = 0.5f, minimumThreshold = 0.05f;
+
+        // -1 while running, 0 if the click never came back, else the samples it took
+        int getResult() const noexcept { return result.load(); }
+
+        void audioDeviceAboutToStart(juce::AudioIODevice* device) override
+        {
+            // A restart starts the measurement over, at the new buffer size
+            listenSamples = juce::roundToInt(listenSeconds * device->getCurrentSampleRate());
+            timeoutSamples = juce::roundToInt(timeoutSeconds * device->getCurrentSampleRate());
+            clock = 0;
+            clickAt = -1;
+            noisePeak = 0.0f;
+            result.store(-1);
+        }
+
+        void audioDeviceStopped() override {}
+
+        void audioDeviceIOCallbackWithContext(const float* const* inputs, int numInputs,
+                                              float* const* outputs, int numOutputs, int numSamples,
+                                              const juce::AudioIODeviceCallbackContext&) override
+        {
+            for (int ch = 0; ch < numOutputs; ++ch)
+                if (outputs[ch] != nullptr)
+                    juce::FloatVectorOperations::clear(outputs[ch], numSamples);
+
+            if (result.load(std::memory_order_relaxed) >= 0)
+                return;
+
+            for (int i = 0; i < numSamples; ++i, ++clock)
+            {
+                float level = 0.0f;
+                for (int ch = 0; ch < numInputs; ++ch)
+                    if (inputs[ch] != nullptr)
+                        level = juce::jmax(level, std::abs(inputs[ch][i]));
+
+                if (clickAt < 0)
+                {
+                    if (clock < listenSamples)
+                    {
+                        noisePeak = juce::jmax(noisePeak, level);
+                        continue;
+                    }
+
+                    clickAt = clock;
+                    threshold = juce::jmax(minimumThreshold, 4.0f * noisePeak);
+
+                    for (int ch = 0; ch < numOutputs; ++ch)
+                        if (outputs[ch] != nullptr)
+                            outputs[ch][i] = clickLevel;
+                }
+                else if (level > threshold)
+                {
+                    result.store((int)(clock - clickAt));
+                    return;
+                }
+                else if (clock - clickAt > timeoutSamples)
+                {
+                    result.store(0);
+                    return;
+                }
+            }
+        }
+
+    private:
+        int listenSamples = 0, timeoutSamples = 0;
+        juce::int64 clock = 0, clickAt = -1;
+        float noisePeak = 0.0f, threshold = minimumThreshold;
+        std::atomic<int> result{ -1 };
+    };
+
+    void stopProbe()
+    {
+        if (probe == nullptr)
+            return;
+
+        deviceManager.removeAudioCallback(probe.get());
+        probe.reset();
+        readout.measuring = false;
+    }
+
+    // Message thread, from the poll: takes a finished measurement off the device
+    void collectProbeResult()
+    {
+        if (probe == nullptr)
+            return;
+
+        const int samples = probe->getResult();
+        if (samples < 0)
+            return;
+
+        stopProbe();
+        readout.measuredRoundTripSamples = samples > 0 ? samples + processor.getLatencySamples() : -1;
+    }
+
+    void applyBufferSize(int size)
+    {
+        auto setup = deviceManager.getAudioDeviceSetup();
+        if (setup.bufferSize != size)
+        {
+            setup.bufferSize = size;
+            deviceManager.setAudioDeviceSetup(setup, true);
+
+            // Measured at another size
+            readout.measuredRoundTripSamples = 0;
+        }
+
+        sizeAppliedAt = juce::Time::getMillisecondCounterHiRes();
+    }
+
+    // Both counters start again from zero when the device restarts
+    static int advance(int now, int& last) noexcept
+    {
+        const int delta = now >= last ? now - last : juce::jmax(0, now);
+        last = now;
+        return delta;
+    }
+
+    void timerCallback() override
+    {
+        auto* device = deviceManager.getCurrentAudioDevice();
+        if (device == nullptr)
+            return;
+
+        const auto stats = processor.getProcessingStats();
+        const int deviceXruns = device->getXRunCount();
+
+        const int processorMisses = advance(stats.xrunCount, lastDeadlineMisses);
+        const int driverXruns = deviceXruns >= 0 ? advance(deviceXruns, lastDeviceXruns) : 0;
+
+        // A restart glitches by itself, so polls right after one only move the baselines
+        const auto elapsed = (juce::Time::getMillisecondCounterHiRes() - sizeAppliedAt) * 0.001;
+        if (elapsed >= restartGraceSeconds)
+        {
+            readout.deadlineMisses += processorMisses;
+            if (deviceXruns >= 0)
+                readout.deviceXruns = juce::jmax(0, readout.deviceXruns) + driverXruns;
+
+            if (!readout.settled)
+            {
+                const bool missed = processorMisses > 0 || driverXruns > 0;
+                if (missed && candidateIndex + 1 < candidateSizes.size())
+                    applyBufferSize(candidateSizes[++candidateIndex]);
+                else if (missed || elapsed >= probeSeconds)
+                    readout.settled = true; // clean through the probe, or nothing larger left
+            }
+        }
+
+        readout.bufferSize = device->getCurrentBufferSizeSamples();
+        readout.sampleRate = device->getCurrentSampleRate();
+        readout.roundTripSamples = device->getInputLatencyInSamples() + device->getOutputLatencyInSamples()
+                                 + processor.getLatencySamples();
+        readout.roundTripMilliseconds = readout.sampleRate > 0.0
+            ? 1000.0 * readout.roundTripSamples / readout.sampleRate
+            : 0.0;
+
+        collectProbeResult();
+        readout.measuredRoundTripMilliseconds = readout.sampleRate > 0.0 && readout.measuredRoundTripSamples > 0
+            ? 1000.0 * readout.measuredRoundTripSamples / readout.sampleRate
+            : 0.0;
+
+        if (onUpdate)
+            onUpdate();
+    }
+
+    DREKAVACAudioProcessor& processor;
+    juce::AudioDeviceManager& deviceManager;
+
+    bool active = false;
+    Readout readout;
+    std::unique_ptr<LoopbackProbe> probe;
+
+    juce::Array<int> candidateSizes; // ascending
+    int candidateIndex = 0;
+    int bufferSizeBeforeLiveMode = 0;
+    double sizeAppliedAt = 0.0;
+
+    int lastDeadlineMisses = 0, lastDeviceXruns = 0;
+
+    JUCE_DECLARE_NON_COPYABLE(LiveModeController)
+};
@@ -0,0 +1,184 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <vector>
+
+//==============================================================================
+// Levels and a decimated scope trace, handed from the audio thread to the editor
+// through two single-producer single-consumer FIFOs. The audio side only copies
+// into preallocated storage and never waits; when nobody reads, new data is
+// dropped instead. Each scope point pairs an output sample with the input sample
+// that produced it, so the editor can plot the transfer curve as well as the wave.
+class MeterFeed
+{
+public:
+    struct Levels
+    {
+        float inputPeak = 0.0f, inputRms = 0.0f;
+        float outputPeak = 0.0f, outputRms = 0.0f;
+    };
+
+    struct ScopePoint
+    {
+        float input = 0.0f, output = 0.0f;
+    };
+
+    static constexpr int levelCapacity = 64;     // blocks
+    static constexpr int scopeCapacity = 2048;   // points, about ten display frames
+    static constexpr double scopeRate = 12000.0; // points per second
+
+    // Message thread, while the audio thread is stopped. The input history only
+    // keeps as much as the longest latency the output can be lined up against,
+    // beyond one block of the size the host announced.
+    void prepare(double sampleRate, int maximumBlockSize, int maximumLatencySamples)
+    {
+        decimation = juce::jmax(1, juce::roundToInt(sampleRate / scopeRate));
+        nextScopeSample = 0;
+
+        maxLatencySamples = juce::jmax(0, maximumLatencySamples);
+        history.assign((size_t)juce::nextPowerOfTwo(maximumBlockSize + maxLatencySamples), 0.0f);
+        historyMask = (int)history.size() - 1;
+        historyWritePosition = 0;
+
+        levelFifo.reset();
+        scopeFifo.reset();
+    }
+
+    //==============================================================================
+    // Audio thread
+
+    template <typename SampleType>
+    void captureInput(const juce::AudioBuffer<SampleType>& buffer, int numChannels) noexcept
+    {
+        pending = {};
+        measure(buffer, numChannels, pending.inputPeak, pending.inputRms);
+
+        if (history.empty() || numChannels <= 0)
+            return;
+
+        const auto* input = buffer.getReadPointer(0);
+        for (int i = 0; i < buffer.getNumSamples(); ++i)
+            history[(size_t)((historyWritePosition + i) & historyMask)] = (float)input[i];
+    }
+
+    // Pairs each kept output sample with the input from latencySamples earlier.
+    // A block longer than the history has overwritten the start of its own
+    // input, so only its last part is plotted.
+    template <typename SampleType>
+    void captureOutput(const juce::AudioBuffer<SampleType>& buffer, int numChannels, int latencySamples) noexcept
+    {
+        measure(buffer, numChannels, pending.outputPeak, pending.outputRms);
+        pushLevels();
+
+        if (history.empty() || numChannels <= 0)
+            return;
+
+        const int numSamples = buffer.getNumSamples();
+        const int latency = juce::jlimit(0, maxLatencySamples, latencySamples);
+        const auto* output = buffer.getReadPointer(0);
+
+        // First sample whose input the history still holds, rounded up to the spacing
+        const int firstPairable = numSamples - ((int)history.size() - latency);
+        if (nextScopeSample < firstPairable)
+            nextScopeSample += (firstPairable - nextScopeSample + decimation - 1) / decimation * decimation;
+
+        const int numPoints = nextScopeSample < numSamples
+            ? (numSamples - 1 - nextScopeSample) / decimation + 1
+            : 0;
+
+        int start1, size1, start2, size2;
+        scopeFifo.prepareToWrite(numPoints, start1, size1, start2, size2);
+
+        int i = nextScopeSample;
+        auto write = [&](int start, int size)
+            {
+                for (int n = 0; n < size; ++n, i += decimation)
+                    scope[(size_t)(start + n)] = { history[(size_t)((historyWritePosition + i - latency) & historyMask)],
+                                                   (float)output[i] };
+            };
+
+        write(start1, size1);
+        write(start2, size2);
+        scopeFifo.finishedWrite(size1 + size2);
+
+        // Keep the spacing across blocks, even for points the FIFO had no room for
+        nextScopeSample += numPoints * decimation - numSamples;
+        historyWritePosition = (historyWritePosition + numSamples) & historyMask;
+    }
+
+    //==============================================================================
+    // Message thread, one reader
+
+    int readLevels(Levels* destination, int maxNumToRead) noexcept
+    {
+        return read(levelFifo, levels.data(), destination, maxNumToRead);
+    }
+
+    int readScope(ScopePoint* destination, int maxNumToRead) noexcept
+    {
+        return read(scopeFifo, scope.data(), destination, maxNumToRead);
+    }
+
+    // Allocated beyond sizeof(MeterFeed)
+    size_t getHeapBytes() const noexcept { return history.capacity() * sizeof(float); }
+
+private:
+    template <typename SampleType>
+    static void measure(const juce::AudioBuffer<SampleType>& buffer, int numChannels, float& peak, float& rms) noexcept
+    {
+        numChannels = juce::jmin(numChannels, buffer.getNumChannels());
+        if (numChannels <= 0 || buffer.getNumSamples() <= 0)
+            return;
+
+        double sumOfSquares = 0.0;
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            peak = juce::jmax(peak, (float)buffer.getMagnitude(ch, 0, buffer.getNumSamples()));
+
+            const auto channelRms = (double)buffer.getRMSLevel(ch, 0, buffer.getNumSamples());
+            sumOfSquares += channelRms * channelRms;
+        }
+
+        rms = (float)std::sqrt(sumOfSquares / numChannels);
+    }
+
+    void pushLevels() noexcept
+    {
+        int start1, size1, start2, size2;
+        levelFifo.prepareToWrite(1, start1, size1, start2, size2);
+
+        if (size1 > 0)
+            levels[(size_t)start1] = pending;
+
+        levelFifo.finishedWrite(size1);
+    }
+
+    template <typename Item>
+    static int read(juce::AbstractFifo& fifo, const Item* storage, Item* destination, int maxNumToRead) noexcept
+    {
+        int start1, size1, start2, size2;
+        fifo.prepareToRead(maxNumToRead, start1, size1, start2, size2);
+
+        std::copy_n(storage + start1, size1, destination);
+        std::copy_n(storage + start2, size2, destination + size1);
+
+        fifo.finishedRead(size1 + size2);
+        return size1 + size2;
+    }
+
+    juce::AbstractFifo levelFifo{ levelCapacity };
+    std::array<Levels, levelCapacity> levels{};
+    Levels pending;
+
+    juce::AbstractFifo scopeFifo{ scopeCapacity };
+    std::array<ScopePoint, scopeCapacity> scope{};
+    int decimation = 1;
+    int nextScopeSample = 0; // offset of the next kept sample into the coming block
+
+    // Recent input of the first channel, so output can be paired with its source
+    std::vector<float> history;
+    int maxLatencySamples = 0;
+    int historyMask = 0;
+    int historyWritePosition = 0;
+};
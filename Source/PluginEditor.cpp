@@ -1,6 +1,10 @@
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
 
+#if JucePlugin_Build_Standalone
+ #include <juce_audio_plugin_client/Standalone/juce_StandaloneFilterWindow.h>
+#endif
+
 DREKAVACAudioProcessorEditor::DREKAVACAudioProcessorEditor(DREKAVACAudioProcessor& p)
     : AudioProcessorEditor(&p), audioProcessor(p)
 {
@@ -9,8 +13,6 @@ DREKAVACAudioProcessorEditor::DREKAVACAudioProcessorEditor(DREKAVACAudioProcesso
     outlinedButtonLAF = std::make_unique<OutlinedButtonLAF>();
     setLookAndFeel(customLAF.get());
 
-    backgroundImage = juce::ImageCache::getFromMemory(BinaryData::Background_png, BinaryData::Background_pngSize);
-
     //Slider setup
     auto setupSlider = [this](juce::Slider& slider, juce::Label& label,
         const juce::String& paramID, const juce::String& labelText,
@@ -23,7 +25,7 @@ DREKAVACAudioProcessorEditor::DREKAVACAudioProcessorEditor(DREKAVACAudioProcesso
 
             label.setText(labelText, juce::dontSendNotification);
             label.setJustificationType(juce::Justification::centred);
-            label.setFont(juce::Font("Gajraj One", 18.0f, juce::Font::plain));
+            label.setFont(resources->controlFont);
             addAndMakeVisible(label);
 
             attachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
@@ -43,7 +45,7 @@ DREKAVACAudioProcessorEditor::DREKAVACAudioProcessorEditor(DREKAVACAudioProcesso
 
     foldLabel.setText("Fold", juce::dontSendNotification);
     foldLabel.setJustificationType(juce::Justification::centred);
-    foldLabel.setFont(juce::Font("Gajraj One", 18.0f, juce::Font::plain));
+    foldLabel.setFont(resources->controlFont);
     addAndMakeVisible(foldLabel);
 
     // Attach slider to parameter
@@ -68,13 +70,13 @@ DREKAVACAudioProcessorEditor::DREKAVACAudioProcessorEditor(DREKAVACAudioProcesso
     //Preset labels
     presetTitleLabel.setText("PRESET", juce::dontSendNotification);
     presetTitleLabel.setJustificationType(juce::Justification::centred);
-    presetTitleLabel.setFont(juce::Font("Gajraj One", 16.0f, juce::Font::plain));
+    presetTitleLabel.setFont(resources->presetTitleFont);
     presetTitleLabel.setColour(juce::Label::textColourId, juce::Colour(232, 232, 232));
     addAndMakeVisible(presetTitleLabel);
 
     presetNameLabel.setText("Default", juce::dontSendNotification);
     presetNameLabel.setJustificationType(juce::Justification::centred);
-    presetNameLabel.setFont(juce::Font("Gajraj One", 14.0f, juce::Font::plain));
+    presetNameLabel.setFont(resources->presetNameFont);
     presetNameLabel.setColour(juce::Label::textColourId, juce::Colour(205, 70, 130));
     addAndMakeVisible(presetNameLabel);
 
@@ -122,25 +124,93 @@ DREKAVACAudioProcessorEditor::DREKAVACAudioProcessorEditor(DREKAVACAudioProcesso
                     });
         };
 
+    // Live mode only makes sense where the plugin owns the audio device
+#if JucePlugin_Build_Standalone
+    if (juce::JUCEApplicationBase::isStandaloneApp())
+        if (auto* holder = juce::StandalonePluginHolder::getInstance())
+            liveMode = std::make_unique<LiveModeController>(audioProcessor, holder->deviceManager);
+#endif
+
+    if (liveMode != nullptr)
+    {
+        liveButton.setButtonText("LIVE");
+        liveButton.setClickingTogglesState(true);
+        liveButton.setLookAndFeel(outlinedButtonLAF.get());
+        liveButton.onClick = [this] { liveMode->setActive(liveButton.getToggleState()); };
+        addAndMakeVisible(liveButton);
+
+        // Times a click through an output patched back to an input
+        loopButton.setButtonText("LOOP");
+        loopButton.setLookAndFeel(outlinedButtonLAF.get());
+        loopButton.onClick = [this] { liveMode->measureRoundTrip(); };
+        addChildComponent(loopButton);
+
+        // Small print, so the default look and feel rather than the display face
+        liveReadout.setLookAndFeel(&juce::LookAndFeel::getDefaultLookAndFeel());
+        liveReadout.setFont(juce::Font(juce::Font::getDefaultMonospacedFontName(), 11.0f, juce::Font::plain));
+        liveReadout.setJustificationType(juce::Justification::centred);
+        liveReadout.setColour(juce::Label::textColourId, juce::Colour(232, 232, 232));
+        addAndMakeVisible(liveReadout);
+
+        liveMode->onUpdate = [this] { updateLiveReadout(); };
+        updateLiveReadout();
+    }
+
+    // Meters and scope, under the sliders
+    addAndMakeVisible(levelScope);
+
+    // Timing overlay, hidden until the header is double-clicked
+    addChildComponent(statsOverlay);
+
+    // paint() covers every pixel, so nothing behind the editor is redrawn for it
+    setOpaque(true);
+
     setSize(400, 600);
 }
 
 DREKAVACAudioProcessorEditor::~DREKAVACAudioProcessorEditor()
 {
+    liveMode.reset();
+
     saveButton.setLookAndFeel(nullptr);
     loadButton.setLookAndFeel(nullptr);
+    liveButton.setLookAndFeel(nullptr);
+    loopButton.setLookAndFeel(nullptr);
+    liveReadout.setLookAndFeel(nullptr);
     setLookAndFeel(nullptr);
 }
 
 //==============================================================================
 
 void DREKAVACAudioProcessorEditor::paint(juce::Graphics& g)
+{
+    // The chrome never changes under the controls, so it is drawn once per size
+    // and display scale and blitted from then on, clipped to whatever is dirty
+    const auto scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+
+    if (!chromeCache.isValid() || scale != chromeScale)
+    {
+        chromeScale = scale;
+        chromeCache = juce::Image(juce::Image::RGB,
+                                  juce::jmax(1, juce::roundToInt((float)getWidth() * scale)),
+                                  juce::jmax(1, juce::roundToInt((float)getHeight() * scale)),
+                                  false);
+
+        juce::Graphics cacheGraphics(chromeCache);
+        cacheGraphics.addTransform(juce::AffineTransform::scale(scale));
+        paintChrome(cacheGraphics);
+    }
+
+    g.drawImageTransformed(chromeCache, juce::AffineTransform::scale(1.0f / chromeScale));
+}
+
+void DREKAVACAudioProcessorEditor::paintChrome(juce::Graphics& g)
 {
     g.fillAll(juce::Colour(20, 20, 30));
 
     // Draw background image if available
-    if (backgroundImage.isValid())
-        g.drawImageAt(backgroundImage, 0, 60); // just place it 60px down
+    if (resources->background.isValid())
+        g.drawImageAt(resources->background, 0, 60); // just place it 60px down
     else
         g.fillAll(juce::Colour(18, 18, 25));
 
@@ -155,16 +225,69 @@ void DREKAVACAudioProcessorEditor::paint(juce::Graphics& g)
 
     g.drawRect(getLocalBounds(), 2.0f);
 
-    g.setFont(juce::Font("Gajraj One", 48.0f, juce::Font::plain));
+    g.setFont(resources->titleFont);
     g.drawText("DREKAVAC", 0, 0, getWidth(), 60, juce::Justification::centred);
 
     g.setColour(juce::Colour(232, 232, 232));
-    g.setFont(juce::Font("Gajraj One", 24.0f, juce::Font::plain));
+    g.setFont(resources->labelFont);
     g.drawText("DISTEK", 0, 40, getWidth(), 20, juce::Justification::centred);
 }
 
+void DREKAVACAudioProcessorEditor::updateLiveReadout()
+{
+    const auto& readout = liveMode->getReadout();
+    liveButton.setButtonText(liveMode->isActive() ? (readout.settled ? "LIVE: ON" : "LIVE: ...") : "LIVE");
+    loopButton.setVisible(liveMode->isActive());
+    loopButton.setEnabled(!readout.measuring);
+
+    if (!liveMode->isActive())
+    {
+        liveReadout.setText("off", juce::dontSendNotification);
+        return;
+    }
+
+    // A measured round trip, once there is one, replaces the reported figure
+    auto text = juce::String(readout.bufferSize) + " smp, ";
+    if (readout.measuring)
+        text << "measuring";
+    else if (readout.measuredRoundTripSamples > 0)
+        text << "measured " << juce::String(readout.measuredRoundTripMilliseconds, 1) << " ms";
+    else if (readout.measuredRoundTripSamples < 0)
+        text << "no loop, rep. " << juce::String(readout.roundTripMilliseconds, 1) << " ms";
+    else
+        text << "reported " << juce::String(readout.roundTripMilliseconds, 1) << " ms";
+
+    text << "\nmiss " << juce::String(readout.deadlineMisses);
+
+    if (readout.deviceXruns >= 0)
+        text << "  xrun " << readout.deviceXruns;
+
+    liveReadout.setText(text, juce::dontSendNotification);
+}
+
+void DREKAVACAudioProcessorEditor::mouseDoubleClick(const juce::MouseEvent& event)
+{
+    if (event.y >= 60)
+        return;
+
+#if DREKAVAC_ENABLE_TRACING
+    // Tracing builds: shift double-click saves the timeline to the desktop
+    if (event.mods.isShiftDown())
+    {
+        const auto file = juce::File::getSpecialLocation(juce::File::userDesktopDirectory)
+            .getNonexistentChildFile("DREKAVAC-trace", ".json");
+        Trace::exportJson(file);
+        return;
+    }
+#endif
+
+    statsOverlay.setVisible(!statsOverlay.isVisible());
+}
+
 void DREKAVACAudioProcessorEditor::resized()
 {
+    chromeCache = {};
+
     int margin = 20;
     int sliderHeight = 40;
     int labelHeight = 20;
@@ -200,4 +323,16 @@ void DREKAVACAudioProcessorEditor::resized()
     saveButton.setBounds(rightX, footerTop + 5, buttonWidth, buttonHeight);
     loadButton.setBounds(rightX, footerTop + 5 + buttonHeight + buttonGap, buttonWidth, buttonHeight);
 
+    // Centre of the footer, between the preset name and the buttons
+    const int liveWidth = 80, loopWidth = 40;
+    liveButton.setBounds((getWidth() - liveWidth - buttonGap - loopWidth) / 2, footerTop + 5, liveWidth, buttonHeight);
+    loopButton.setBounds(liveButton.getRight() + buttonGap, footerTop + 5, loopWidth, buttonHeight);
+    liveReadout.setBounds(120, footerTop + 5 + buttonHeight, getWidth() - 240, 60 - 10 - buttonHeight);
+
+    // Between the last row of sliders and the footer
+    levelScope.setBounds(margin / 2, juce::jmax(yLeft, yRight), getWidth() - margin, footerTop - 5 - juce::jmax(yLeft, yRight));
+
+    // Between the header and the first row of sliders
+    statsOverlay.setBounds(margin / 2, 66, getWidth() - margin, 82);
+
 }
@@ -2,10 +2,37 @@
 
 #include <JuceHeader.h>
 #include "PluginProcessor.h"
+#include "LiveMode.h"
+
+//==============================================================================
+// Typeface, background and fonts, loaded once per process and shared by every
+// editor through a SharedResourcePointer, so opening another editor decodes nothing
+struct EditorResources
+{
+    EditorResources()
+        : typeface(juce::Typeface::createSystemTypefaceFor(BinaryData::GajrajOneRegular_ttf,
+                                                           BinaryData::GajrajOneRegular_ttfSize)),
+          background(juce::ImageFileFormat::loadFrom(BinaryData::Background_png, BinaryData::Background_pngSize))
+    {
+    }
+
+    juce::Font font(float height) const { return juce::Font(juce::FontOptions(typeface).withHeight(height)); }
+
+    const juce::Typeface::Ptr typeface;
+    const juce::Image background;
+
+    const juce::Font titleFont{ font(48.0f) };
+    const juce::Font labelFont{ font(24.0f) };
+    const juce::Font controlFont{ font(18.0f) };
+    const juce::Font presetTitleFont{ font(16.0f) };
+    const juce::Font presetNameFont{ font(14.0f) };
+};
 
 //LookAndFeel for outlined buttons
 struct OutlinedButtonLAF : public juce::LookAndFeel_V4
 {
+    juce::SharedResourcePointer<EditorResources> resources;
+
     void drawButtonBackground(juce::Graphics& g, juce::Button& button,
         const juce::Colour& /*backgroundColour*/,
         bool shouldDrawButtonAsHighlighted,
@@ -31,7 +58,7 @@ struct OutlinedButtonLAF : public juce::LookAndFeel_V4
         bool /*shouldDrawButtonAsDown*/) override
     {
         g.setColour(juce::Colour(205, 70, 130));
-        g.setFont(juce::Font("Gajraj One", 18.0f, juce::Font::plain));
+        g.setFont(resources->controlFont);
         g.drawFittedText(button.getButtonText(), button.getLocalBounds(),
             juce::Justification::centred, 1);
     }
@@ -41,23 +68,15 @@ struct OutlinedButtonLAF : public juce::LookAndFeel_V4
 class CustomLookAndFeel : public juce::LookAndFeel_V4
 {
 public:
-    CustomLookAndFeel()
-    {
-        gajrajTypeface = juce::Typeface::createSystemTypefaceFor(
-            BinaryData::GajrajOneRegular_ttf,
-            BinaryData::GajrajOneRegular_ttfSize
-        );
-    }
-
     juce::Typeface::Ptr getTypefaceForFont(const juce::Font&) override
     {
-        return gajrajTypeface;
+        return resources->typeface;
     }
 
     void drawLabel(juce::Graphics& g, juce::Label& label) override
     {
         g.setColour(label.findColour(juce::Label::textColourId));
-        g.setFont(juce::Font("Gajraj One", 24.0f, juce::Font::plain));
+        g.setFont(resources->labelFont);
         g.drawFittedText(label.getText(), label.getLocalBounds(),
             label.getJustificationType(), 1);
     }
@@ -92,7 +111,205 @@ public:
         g.strokePath(triangle, juce::PathStrokeType(2.0f));
     }
 private:
-    juce::Typeface::Ptr gajrajTypeface;
+    juce::SharedResourcePointer<EditorResources> resources;
+};
+
+//==============================================================================
+// Debug readout of the processor's timings, polled while visible
+class ProcessingStatsOverlay : public juce::Component,
+                               private juce::Timer
+{
+public:
+    explicit ProcessingStatsOverlay(DREKAVACAudioProcessor& p) : audioProcessor(p)
+    {
+        setInterceptsMouseClicks(false, false);
+
+        // The editor's look and feel maps every font to the display face
+        setLookAndFeel(&juce::LookAndFeel::getDefaultLookAndFeel());
+    }
+
+    ~ProcessingStatsOverlay() override
+    {
+        setLookAndFeel(nullptr);
+    }
+
+    void visibilityChanged() override
+    {
+        if (isVisible())
+            startTimerHz(10);
+        else
+            stopTimer();
+    }
+
+    void paint(juce::Graphics& g) override
+    {
+        g.setColour(juce::Colour(20, 20, 30).withAlpha(0.85f));
+        g.fillRect(getLocalBounds());
+        g.setColour(juce::Colour(205, 70, 130));
+        g.drawRect(getLocalBounds(), 1);
+
+        auto percent = [](double proportion) { return juce::String(proportion * 100.0, 1) + "%"; };
+        auto micros = [](double us) { return juce::String(us, 1) + " us"; };
+        auto kilobytes = [](size_t bytes) { return juce::String((double)bytes / 1024.0, 1) + " KB"; };
+
+        const juce::StringArray lines{
+            "Block " + micros(stats.blockMicroseconds) + " (" + percent(stats.blockLoad) + ")  peak "
+                + micros(stats.peakBlockMicroseconds) + " (" + percent(stats.peakLoad) + ")",
+            "Load " + percent(stats.averageLoad) + "  xruns " + juce::String(stats.xrunCount)
+                + "  latency " + juce::String(stats.latencySamples) + " smp",
+            "Up " + micros(stats.stageMicroseconds[ProcessingStats::upsample])
+                + "  Chain " + micros(stats.stageMicroseconds[ProcessingStats::chain]),
+            "Down " + micros(stats.stageMicroseconds[ProcessingStats::downsample])
+                + "  Output " + micros(stats.stageMicroseconds[ProcessingStats::output]),
+            "Heap ~" + kilobytes(footprint.instanceBytes) + " est.  tables " + kilobytes(footprint.sharedBytes),
+        };
+
+        g.setColour(juce::Colour(232, 232, 232));
+        g.setFont(juce::Font(juce::Font::getDefaultMonospacedFontName(), 12.0f, juce::Font::plain));
+
+        auto area = getLocalBounds().reduced(6, 4);
+        const int lineHeight = area.getHeight() / lines.size();
+        for (auto& line : lines)
+            g.drawText(line, area.removeFromTop(lineHeight), juce::Justification::centredLeft, true);
+    }
+
+private:
+    void timerCallback() override
+    {
+        stats = audioProcessor.getProcessingStats();
+        footprint = audioProcessor.getMemoryFootprint();
+        repaint();
+    }
+
+    DREKAVACAudioProcessor& audioProcessor;
+    ProcessingStats stats;
+    DREKAVACAudioProcessor::MemoryFootprint footprint;
+};
+
+//==============================================================================
+// Input and output meters beside a scope of the latest output, with the transfer
+// curve (output against the input that produced it) drawn over it. Drained once
+// per display frame from the processor's meter feed; repaints only on new data.
+class LevelScopeView : public juce::Component
+{
+public:
+    explicit LevelScopeView(DREKAVACAudioProcessor& p) : meterFeed(p.getMeterFeed())
+    {
+        setInterceptsMouseClicks(false, false);
+    }
+
+    void paint(juce::Graphics& g) override
+    {
+        auto area = getLocalBounds().toFloat();
+        const auto pink = juce::Colour(205, 70, 130);
+        const auto text = juce::Colour(232, 232, 232);
+
+        g.setColour(juce::Colour(20, 20, 30).withAlpha(0.7f));
+        g.fillRect(area);
+
+        // Meters: dB bars over a -60..0 dB scale, RMS solid and peak as a line
+        auto drawMeter = [&g, pink, text](juce::Rectangle<float> bar, float peak, float rms)
+            {
+                auto proportion = [](float gain)
+                    { return juce::jlimit(0.0f, 1.0f, juce::Decibels::gainToDecibels(gain, -60.0f) / 60.0f + 1.0f); };
+
+                g.setColour(juce::Colour(61, 57, 97));
+                g.fillRect(bar);
+                g.setColour(pink);
+                g.fillRect(bar.withTop(bar.getBottom() - bar.getHeight() * proportion(rms)));
+                g.setColour(text);
+                g.fillRect(bar.withTop(bar.getBottom() - bar.getHeight() * proportion(peak)).withHeight(2.0f));
+            };
+
+        auto inner = area.reduced(4.0f);
+        drawMeter(inner.removeFromLeft(8.0f), shown.inputPeak, shown.inputRms);
+        drawMeter(inner.removeFromRight(8.0f), shown.outputPeak, shown.outputRms);
+        inner.reduce(6.0f, 0.0f);
+
+        // Transfer curve in a square on the right, the scope trace in what is left
+        auto curveArea = inner.removeFromRight(inner.getHeight());
+        inner.removeFromRight(6.0f);
+
+        g.setColour(text.withAlpha(0.25f));
+        g.drawRect(curveArea, 1.0f);
+        g.drawHorizontalLine(juce::roundToInt(inner.getCentreY()), inner.getX(), inner.getRight());
+
+        if (numPoints == 0)
+            return;
+
+        juce::Path wave;
+        for (int i = 0; i < numPoints; ++i)
+        {
+            const auto& point = points[(size_t)((firstPoint + i) % maxPoints)];
+            const auto x = inner.getX() + inner.getWidth() * (float)i / (float)juce::jmax(1, numPoints - 1);
+            const auto y = inner.getCentreY() - juce::jlimit(-1.0f, 1.0f, point.output) * inner.getHeight() * 0.5f;
+
+            if (i == 0)
+                wave.startNewSubPath(x, y);
+            else
+                wave.lineTo(x, y);
+
+            g.setColour(pink);
+            g.fillRect(curveArea.getCentreX() + juce::jlimit(-1.0f, 1.0f, point.input) * curveArea.getWidth() * 0.5f,
+                       curveArea.getCentreY() - juce::jlimit(-1.0f, 1.0f, point.output) * curveArea.getHeight() * 0.5f,
+                       1.5f, 1.5f);
+        }
+
+        g.setColour(text);
+        g.strokePath(wave, juce::PathStrokeType(1.0f));
+    }
+
+private:
+    // Latest points kept on screen
+    static constexpr int maxPoints = 512;
+
+    void update()
+    {
+        bool changed = false;
+
+        // Peaks hold the loudest block since the last frame and then fall off
+        shown.inputPeak *= 0.9f;
+        shown.outputPeak *= 0.9f;
+
+        std::array<MeterFeed::Levels, MeterFeed::levelCapacity> levels;
+        const int numLevels = meterFeed.readLevels(levels.data(), (int)levels.size());
+        for (int i = 0; i < numLevels; ++i)
+        {
+            shown.inputPeak = juce::jmax(shown.inputPeak, levels[(size_t)i].inputPeak);
+            shown.outputPeak = juce::jmax(shown.outputPeak, levels[(size_t)i].outputPeak);
+            shown.inputRms = levels[(size_t)i].inputRms;
+            shown.outputRms = levels[(size_t)i].outputRms;
+            changed = true;
+        }
+
+        // Straight into the display ring; only the newest maxPoints matter
+        std::array<MeterFeed::ScopePoint, 256> chunk;
+        while (const int numRead = meterFeed.readScope(chunk.data(), (int)chunk.size()))
+        {
+            for (int i = 0; i < numRead; ++i)
+            {
+                points[(size_t)((firstPoint + numPoints) % maxPoints)] = chunk[(size_t)i];
+
+                if (numPoints < maxPoints)
+                    ++numPoints;
+                else
+                    firstPoint = (firstPoint + 1) % maxPoints;
+            }
+
+            changed = true;
+        }
+
+        if (changed)
+            repaint();
+    }
+
+    MeterFeed& meterFeed;
+    MeterFeed::Levels shown;
+
+    std::array<MeterFeed::ScopePoint, maxPoints> points{};
+    int firstPoint = 0, numPoints = 0;
+
+    juce::VBlankAttachment vblank{ this, [this] { update(); } };
 };
 
 //==============================================================================
@@ -106,6 +323,10 @@ public:
     void paint(juce::Graphics&) override;
     void resized() override;
 
+    // Double-clicking the header toggles the timing overlay; with shift held,
+    // tracing builds save the trace instead
+    void mouseDoubleClick(const juce::MouseEvent& event) override;
+
 private:
     DREKAVACAudioProcessor& audioProcessor;
 
@@ -113,8 +334,13 @@ private:
     std::unique_ptr<CustomLookAndFeel> customLAF;
     std::unique_ptr<OutlinedButtonLAF> outlinedButtonLAF;
 
-    // Background
-    juce::Image backgroundImage;
+    juce::SharedResourcePointer<EditorResources> resources;
+
+    // Background, bars and title, rendered at chromeScale physical pixels per point
+    juce::Image chromeCache;
+    float chromeScale = 0.0f;
+
+    void paintChrome(juce::Graphics& g);
 
     // Sliders
     juce::Slider driveSlider, toneSlider, distortionSlider, cutoffSlider;
@@ -129,6 +355,14 @@ private:
     juce::TextButton saveButton;
     juce::TextButton loadButton;
 
+    // Standalone only: live mode switch, loopback measurement and the latency
+    // and miss readout
+    std::unique_ptr<LiveModeController> liveMode;
+    juce::TextButton liveButton, loopButton;
+    juce::Label liveReadout;
+
+    void updateLiveReadout();
+
     // Attachments
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> driveAttachment;
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> toneAttachment;
@@ -146,6 +380,9 @@ private:
     };
     std::vector<SliderWithLabel> sliders;
 
+    ProcessingStatsOverlay statsOverlay{ audioProcessor };
+    LevelScopeView levelScope{ audioProcessor };
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DREKAVACAudioProcessorEditor)
 
 };
@@ -1,5 +1,9 @@
-#include "PluginProcessor.h"
+﻿#include "PluginProcessor.h"
+
+// Headless tools build the processor without the editor and its BinaryData
+#if ! DREKAVAC_HEADLESS
 #include "PluginEditor.h"
+#endif
 
 // Helper to create parameter layout
 juce::AudioProcessorValueTreeState::ParameterLayout DREKAVACAudioProcessor::createParameterLayout()
@@ -97,6 +101,38 @@ juce::AudioProcessorValueTreeState::ParameterLayout DREKAVACAudioProcessor::crea
         }
     ));
 
+    // Oversampling factor and anti-aliasing filter design
+    params.push_back(std::make_unique<juce::AudioParameterChoice>(
+        "oversampling", "Oversampling", juce::StringArray{ "1x", "2x", "4x", "8x" }, 2));
+    params.push_back(std::make_unique<juce::AudioParameterChoice>(
+        "osfilter", "Oversampling Filter", juce::StringArray{ "IIR", "Linear Phase" }, 0));
+
+    // Quality mode: Auto switches to render quality for offline bounces
+    params.push_back(std::make_unique<juce::AudioParameterChoice>(
+        "quality", "Quality", juce::StringArray{ "Auto", "Realtime", "Render" }, 0));
+
+    // Realtime shaper curves: rational approximations or lookup tables
+    params.push_back(std::make_unique<juce::AudioParameterChoice>(
+        "shaper", "Shaper", juce::StringArray{ "Analytic", "Table" }, 0));
+
+    // Antiderivative antialiasing per stage, so lower oversampling factors stay clean
+    params.push_back(std::make_unique<juce::AudioParameterBool>("driveadaa", "Overdrive ADAA", false));
+    params.push_back(std::make_unique<juce::AudioParameterBool>("distadaa", "Distortion ADAA", false));
+    params.push_back(std::make_unique<juce::AudioParameterBool>("foldadaa", "Fold ADAA", false));
+
+    // The final clip runs at the original rate. ADAA keeps hot output gains from
+    // aliasing there, but averages neighbouring samples, so it also darkens the
+    // top octave (about -3 dB at a quarter of the rate, near silence at Nyquist)
+    // and delays the output half a sample. Off, it is plain tanh.
+    params.push_back(std::make_unique<juce::AudioParameterBool>("clipadaa", "Output Clip ADAA", false));
+
+    // Output compressor and its lookahead, which adds latency
+    params.push_back(std::make_unique<juce::AudioParameterBool>("compressor", "Compressor", false));
+    params.push_back(std::make_unique<juce::AudioParameterBool>("lookahead", "Lookahead", false));
+
+    // Wide buses spread their channel pairs over a worker pool
+    params.push_back(std::make_unique<juce::AudioParameterBool>("parallel", "Parallel Channels", true));
+
     return { params.begin(), params.end() };
 }
 
@@ -113,9 +149,290 @@ DREKAVACAudioProcessor::DREKAVACAudioProcessor()
     ),
     parameters(*this, nullptr, juce::Identifier("DREKAVAC_PARAMETERS"), createParameterLayout())
 {
+    paramValues.drive = parameters.getRawParameterValue("drive");
+    paramValues.tone = parameters.getRawParameterValue("tone");
+    paramValues.distortion = parameters.getRawParameterValue("distortion");
+    paramValues.cutoff = parameters.getRawParameterValue("cutoff");
+    paramValues.fold = parameters.getRawParameterValue("fold");
+    paramValues.flavor = parameters.getRawParameterValue("flavor");
+    paramValues.output = parameters.getRawParameterValue("output");
+    paramValues.drywet = parameters.getRawParameterValue("drywet");
+    paramValues.oversampling = parameters.getRawParameterValue("oversampling");
+    paramValues.osFilter = parameters.getRawParameterValue("osfilter");
+    paramValues.quality = parameters.getRawParameterValue("quality");
+    paramValues.compressor = parameters.getRawParameterValue("compressor");
+    paramValues.lookahead = parameters.getRawParameterValue("lookahead");
+    paramValues.shaper = parameters.getRawParameterValue("shaper");
+    paramValues.driveADAA = parameters.getRawParameterValue("driveadaa");
+    paramValues.distADAA = parameters.getRawParameterValue("distadaa");
+    paramValues.foldADAA = parameters.getRawParameterValue("foldadaa");
+    paramValues.clipADAA = parameters.getRawParameterValue("clipadaa");
+    paramValues.parallel = parameters.getRawParameterValue("parallel");
+
+    // A new oversampler is built on the message thread, never in processBlock.
+    // Lookahead rides on the same swap, since it moves the latency too.
+    for (size_t i = 0; i < parameterIDs.size(); ++i)
+    {
+        const juce::StringRef id(parameterIDs[i]);
+        const bool movesOversampler = id == "oversampling" || id == "osfilter" || id == "quality" || id == "lookahead";
+
+        parameterListeners.push_back(std::make_unique<ParameterListener>(*this, (int)i, movesOversampler));
+        parameters.addParameterListener(parameterIDs[i], parameterListeners.back().get());
+    }
+
+    juce::StringArray ids;
+    juce::Array<float> defaults;
+    for (auto* id : parameterIDs)
+    {
+        auto* parameter = parameters.getParameter(id);
+        ids.add(id);
+        defaults.add(parameter->convertFrom0to1(parameter->getDefaultValue()));
+    }
+
+    presetBank->setLayout(parameters.state.getType(), ids, defaults);
+    presetBank->addChangeListener(this);
+
+#if ! DREKAVAC_HEADLESS
+    presetBank->scanOnce(PresetBank::getDefaultDirectory());
+#endif
+
+    startTimer(housekeepingIntervalMs);
+}
+
+DREKAVACAudioProcessor::~DREKAVACAudioProcessor()
+{
+    presetBank->removeChangeListener(this);
+
+    for (size_t i = 0; i < parameterIDs.size(); ++i)
+        parameters.removeParameterListener(parameterIDs[i], parameterListeners[i].get());
+
+    // Each chain frees its own oversamplers once no rebuild can race with it
+    stopTimer();
+
+    preparedNumGroups.store(0);
+    updateWorkerPoolUse();
+}
+
+void DREKAVACAudioProcessor::parameterChanged(const ParameterListener& listener, float newValue)
+{
+    // Continuous values moved from another thread while audio runs go on the
+    // timeline. The audio thread's own changes and preset loads apply at block start.
+    const auto audioThread = audioThreadID.load(std::memory_order_relaxed);
+    if (listener.index < ParameterSnapshot::numAutomatable
+        && audioThread != nullptr && audioThread != juce::Thread::getCurrentThreadId()
+        && !presetPending.load(std::memory_order_acquire))
+        automation.push(listener.index, newValue);
+
+    // Can arrive on any thread; the audio thread only compares the counter
+    parameterVersion.fetch_add(1, std::memory_order_release);
+
+    if (listener.rebuildsOversampler)
+        requestOversamplerRebuild();
+}
+
+void DREKAVACAudioProcessor::setNonRealtime(bool isNonRealtime) noexcept
+{
+    const bool changed = isNonRealtime != this->isNonRealtime();
+    AudioProcessor::setNonRealtime(isNonRealtime);
+
+    if (changed && (int)paramValues.quality->load() == 0)
+        requestOversamplerRebuild();
+}
+
+bool DREKAVACAudioProcessor::useRenderQuality() const
+{
+    switch ((int)paramValues.quality->load())
+    {
+        case 1:  return false; // Realtime
+        case 2:  return true;  // Render
+        default: return isNonRealtime();
+    }
+}
+
+void DREKAVACAudioProcessor::requestOversamplerRebuild()
+{
+    // Any thread, the audio thread included; the timer picks it up
+    oversamplerRebuildNeeded.store(true);
+}
+
+int DREKAVACAudioProcessor::getLookaheadSamples() const
+{
+    return paramValues.lookahead->load() >= 0.5f ? SimpleCompressor<float>::getLookaheadSamples(getSampleRate()) : 0;
+}
+
+//==============================================================================
+
+template <typename SampleType>
+std::unique_ptr<SharedOversampling<SampleType>> DREKAVACAudioProcessor::createOversampler() const
+{
+    using Oversampler = SharedOversampling<SampleType>;
+
+    // Choice index 0..3 -> 1x, 2x, 4x, 8x; render quality always runs 8x
+    const auto factorIndex = useRenderQuality() ? (size_t)3
+                                                : (size_t)juce::jlimit(0, 3, (int)paramValues.oversampling->load());
+    const auto filterType = (int)paramValues.osFilter->load() == 0
+        ? Oversampler::filterHalfBandPolyphaseIIR
+        : Oversampler::filterHalfBandFIREquiripple;
+
+    // Integer latency, so what we report to the host is exactly what we add
+    auto newOversampler = std::make_unique<Oversampler>(StereoSample::size(), factorIndex, filterType);
+
+    newOversampler->initProcessing((size_t)preparedBlockSize);
+    return newOversampler;
+}
+
+template <typename SampleType>
+void DREKAVACAudioProcessor::offerOversamplers(ChainState<SampleType>& chain)
+{
+    DREKAVAC_TRACE_SCOPE("offerOversamplers");
+
+    auto newOversamplers = std::make_unique<typename ChainState<SampleType>::OversamplerSet>();
+    for (size_t i = 0; i < chain.groups.size(); ++i)
+        newOversamplers->push_back(createOversampler<SampleType>());
+
+    if (newOversamplers->empty())
+        return;
+
+    setLatencySamples(juce::roundToInt(newOversamplers->front()->getLatencyInSamples()) + getLookaheadSamples());
+
+    // If the audio thread never picked up an earlier build, it is dropped here
+    delete chain.pendingOversamplers.exchange(newOversamplers.release());
+}
+
+void DREKAVACAudioProcessor::timerCallback()
+{
+    // Whatever the audio thread swapped out last time is freed here
+    delete floatChain.retiredOversamplers.exchange(nullptr);
+    delete doubleChain.retiredOversamplers.exchange(nullptr);
+
+    // Follows the Parallel Channels switch
+    updateWorkerPoolUse();
+
+    // A program change the host made off the message thread
+    applyPendingProgram();
+
+    if (!oversamplerRebuildNeeded.exchange(false) || preparedBlockSize <= 0)
+        return;
+
+    if (isUsingDoublePrecision())
+        offerOversamplers(doubleChain);
+    else
+        offerOversamplers(floatChain);
+}
+
+template <typename SampleType>
+void DREKAVACAudioProcessor::prepareOversampledStages(ChainState<SampleType>& chain)
+{
+    // Calculate oversampled rate
+    double oversampledRate = getSampleRate() * (double)chain.groups.front()->oversampler->getOversamplingFactor();
+
+    const auto factor = (juce::uint32)chain.groups.front()->oversampler->getOversamplingFactor();
+    const auto& cutoffTable = *chain.cutoffTables[(size_t)juce::findHighestSetBit(factor)];
+
+    for (auto& group : chain.groups)
+    {
+        group->overdrive.prepare(oversampledRate);
+        group->dist.prepare(oversampledRate, cutoffTable); // Distortion works at oversampled rate
+        group->fold.prepare(oversampledRate);
+    }
+
+    // The flavor blend sums the oversampled stages
+    flavorSmoothed.reset(oversampledRate, parameterSmoothingSeconds);
+}
+
+template <typename SampleType>
+SampleType DREKAVACAudioProcessor::getDryDelay(const ChainState<SampleType>& chain) const
+{
+    // First-order ADAA delays its stage half a sample at the oversampled rate.
+    // Overdrive's half holds back the whole wet sum. Distortion's or fold's only
+    // holds back the share they add next to it, so theirs counts half, taken from
+    // whichever of the two the flavor blend mostly plays.
+    const auto& p = activeParameters;
+    const bool blendMostlyFold = std::sin(p.flavor * juce::MathConstants<float>::halfPi) >= 0.5f;
+    const bool blendADAA = blendMostlyFold ? p.foldADAA : p.distADAA;
+
+    const double adaaDelay = (p.driveADAA ? 0.5 : 0.0) + (blendADAA ? 0.25 : 0.0);
+    const auto factor = (double)chain.groups.front()->oversampler->getOversamplingFactor();
+
+    return (SampleType)(getOversamplerLatency(chain) + adaaDelay / factor);
+}
+
+template <typename SampleType>
+int DREKAVACAudioProcessor::getOversamplerLatency(const ChainState<SampleType>& chain)
+{
+    // Every group runs the same design
+    return juce::roundToInt(chain.groups.front()->oversampler->getLatencyInSamples());
+}
+
+int DREKAVACAudioProcessor::getMaximumOversamplerLatency()
+{
+    // Latency only depends on the factor and filter, so this is worked out once
+    static const int maximumLatency = []
+        {
+            int latency = 0;
+            for (size_t factorIndex = 0; factorIndex <= 3; ++factorIndex)
+                for (auto filterType : { SharedOversampling<float>::filterHalfBandPolyphaseIIR,
+                                         SharedOversampling<float>::filterHalfBandFIREquiripple })
+                {
+                    SharedOversampling<float> candidate(StereoSample::size(), factorIndex, filterType);
+                    latency = juce::jmax(latency, juce::roundToInt(candidate.getLatencyInSamples()));
+                }
+            return latency;
+        }();
+
+    return maximumLatency;
 }
 
-DREKAVACAudioProcessor::~DREKAVACAudioProcessor() {}
+template <typename SampleType>
+size_t DREKAVACAudioProcessor::getChainHeapBytes(const ChainState<SampleType>& chain) const
+{
+    using Group = ChannelGroup<SampleType>;
+
+    auto bufferBytes = [](const juce::AudioBuffer<SampleType>& buffer)
+        { return (size_t)buffer.getNumChannels() * (size_t)buffer.getNumSamples() * sizeof(SampleType); };
+
+    // DelayLine keeps two samples beyond its maximum delay on every channel
+    auto delayBytes = [](const auto& delay, int numChannels)
+        { return (size_t)numChannels * (size_t)(delay.getMaximumDelayInSamples() + 2) * sizeof(SampleType); };
+
+    size_t bytes = chain.groups.capacity() * sizeof(std::unique_ptr<Group>)
+                 + delayBytes(chain.bypassDelay, chain.numChannels);
+
+    for (const auto& group : chain.groups)
+    {
+        bytes += sizeof(Group)
+               + bufferBytes(group->dryBuffer) + bufferBytes(group->distBuffer) + bufferBytes(group->foldBuffer)
+               + delayBytes(group->dryDelay, (int)StereoSample::size())
+               + group->simpleComp.getHeapBytes();
+
+        if (group->oversampler != nullptr)
+            bytes += sizeof(typename Group::Oversampler) + group->oversampler->getHeapBytes();
+    }
+
+    return bytes;
+}
+
+DREKAVACAudioProcessor::MemoryFootprint DREKAVACAudioProcessor::getMemoryFootprint() const
+{
+    MemoryFootprint footprint;
+    footprint.instanceBytes = sizeof(*this) + getChainHeapBytes(floatChain) + getChainHeapBytes(doubleChain)
+                            + meterFeed.getHeapBytes();
+
+    for (const auto& usage : { SharedTables::getUsage<ChainState<float>::CutoffTable>(),
+                               SharedTables::getUsage<ChainState<double>::CutoffTable>(),
+                               SharedTables::getUsage<SharedOversampling<float>::StageDesign>(),
+                               SharedTables::getUsage<SharedOversampling<double>::StageDesign>() })
+    {
+        footprint.sharedBytes += usage.numBytes;
+        footprint.numSharedTables += usage.numTables;
+        footprint.numSharedTableBuilds += usage.numBuilds;
+    }
+
+    // The shaper tables are built on first use and kept for the life of the process
+    footprint.sharedBytes += TableSaturation::getTableBytes();
+    footprint.numSharedTables += 2;
+    return footprint;
+}
 
 //==============================================================================
 
@@ -126,31 +443,137 @@ const juce::String DREKAVACAudioProcessor::getName() const
 
 void DREKAVACAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
 {
-    // Initialize oversampler FIRST
-    oversampler.reset();
-    oversampler.initProcessing(samplesPerBlock);
+    DREKAVAC_TRACE_SCOPE("prepareToPlay");
 
-    // Calculate oversampled rate
-    double oversampledRate = sampleRate * oversampler.getOversamplingFactor();
+    // Initialize oversampler FIRST, built here directly since audio is stopped
+    oversamplerRebuildNeeded.store(false);
+    fadedOutForSwap = false;
+
+    // The chain runs in slices of at most internalBlockSize, so that is all its
+    // buffers need, however large or irregular the host's blocks get
+    preparedBlockSize = internalBlockSize;
+
+    // Shaper tables are built once and shared by every instance
+    TableSaturation::prepare();
+
+    // The host picks the precision before preparing, so only that chain is built
+    if (isUsingDoublePrecision())
+    {
+        floatChain.release();
+        prepareChain(doubleChain, sampleRate, preparedBlockSize);
+    }
+    else
+    {
+        doubleChain.release();
+        prepareChain(floatChain, sampleRate, preparedBlockSize);
+    }
+
+    bypassed = false;
+    silentSamples = 0;
+    processingMeter.prepare(sampleRate, samplesPerBlock);
+    meterFeed.prepare(sampleRate, samplesPerBlock,
+                      getMaximumOversamplerLatency() + SimpleCompressor<float>::getLookaheadSamples(sampleRate));
+
+    preparedNumGroups.store((int)(isUsingDoublePrecision() ? doubleChain.groups.size() : floatChain.groups.size()));
+    updateWorkerPoolUse();
+}
+
+void DREKAVACAudioProcessor::updateWorkerPoolUse()
+{
+    const juce::ScopedLock sl(workerPoolLock);
+
+    const bool wanted = preparedNumGroups.load() > 1 && paramValues.parallel->load() >= 0.5f;
+
+    if (wanted == usingWorkerPool)
+        return;
+
+    usingWorkerPool = wanted;
+
+    if (wanted)
+        workerPool->addUser();
+    else
+        workerPool->removeUser();
+}
+
+template <typename SampleType>
+void DREKAVACAudioProcessor::prepareChain(ChainState<SampleType>& chain, double sampleRate, int samplesPerBlock)
+{
+    delete chain.pendingOversamplers.exchange(nullptr);
+    delete chain.retiredOversamplers.exchange(nullptr);
+
+    // One group per channel pair; an odd last channel gets a group of its own
+    const auto groupSize = (int)StereoSample::size();
+    chain.numChannels = juce::jlimit(1, maxNumChannels, juce::jmax(getTotalNumInputChannels(), getTotalNumOutputChannels()));
+    const auto numGroups = (size_t)((chain.numChannels + groupSize - 1) / groupSize);
+
+    chain.groups.clear();
+    while (chain.groups.size() < numGroups)
+    {
+        auto group = std::make_unique<ChannelGroup<SampleType>>();
+        group->oversampler = createOversampler<SampleType>();
+        chain.groups.push_back(std::move(group));
+    }
+
+    setLatencySamples(getOversamplerLatency(chain) + getLookaheadSamples());
+
+    for (size_t i = 0; i < chain.cutoffTables.size(); ++i)
+    {
+        const int factor = 1 << i;
+        chain.cutoffTables[i] = SharedTables::get<typename ChainState<SampleType>::CutoffTable>(
+            sampleRate, factor, [rate = sampleRate * factor] { return Distortion<SampleType>::makeCutoffTable(rate); });
+    }
+
+    // Load the current knob positions first so prepare() starts every ramp settled on them
+    appliedParameterVersion = parameterVersion.load(std::memory_order_acquire);
+    activeParameters = captureParameters();
+    updateDspParameters(chain);
 
     // Prepare DSP modules with correct sample rates
-    toneProcessor.prepare(sampleRate); // ToneProcessor works at original rate
-    dist.prepare(oversampledRate);     // Distortion works at oversampled rate
-    simpleComp.prepare(sampleRate);    // Compressor works at original rate
+    prepareOversampledStages(chain);
+
+    // Scratch blocks for the stage-by-stage chain, sized for the highest factor
+    // so switching oversampling never reallocates
+    const int maxOversampledSamples = samplesPerBlock * maxOversamplingFactor;
+
+    for (auto& group : chain.groups)
+    {
+        group->toneProcessor.prepare(sampleRate); // ToneProcessor works at original rate
+        group->outputClipper.reset();
+
+        // Sized for the slowest oversampler and a sample of ADAA, so a swap only
+        // has to move the read position
+        group->dryDelay.prepare({ sampleRate, (juce::uint32)samplesPerBlock, (juce::uint32)groupSize });
+        group->dryDelay.setMaximumDelayInSamples(getMaximumOversamplerLatency() + 1);
+        group->dryDelay.setDelay(getDryDelay(chain));
 
-    // Reset other DSP modules with default values
-    overdrive.setDrive(1.0f);
-    overdrive.setTone(0.5f);
+        group->simpleComp.prepare(sampleRate);    // Compressor works at original rate
+        group->simpleComp.setLookaheadSamples(getLookaheadSamples());
 
-    dist.setPreGain(1.0f);
-    dist.setCutoffSliderValue(0.5f);
+        for (auto* scratch : { &group->distBuffer, &group->foldBuffer })
+            scratch->setSize(groupSize, maxOversampledSamples, false, true, false);
 
-    fold.setDepth(0.0f);
+        group->dryBuffer.setSize(groupSize, samplesPerBlock, false, true, false);
+    }
+
+    // Mix gains are applied at the original rate
+    for (auto* smoother : { &dryWetSmoothed, &outputGainSmoothed })
+        smoother->reset(sampleRate, parameterSmoothingSeconds);
+
+    chain.bypassDelay.prepare({ sampleRate, (juce::uint32)samplesPerBlock, (juce::uint32)chain.numChannels });
+    chain.bypassDelay.setMaximumDelayInSamples(getMaximumOversamplerLatency()
+                                               + SimpleCompressor<SampleType>::getLookaheadSamples(sampleRate));
 }
 
 void DREKAVACAudioProcessor::releaseResources()
 {
-    oversampler.reset();
+    preparedNumGroups.store(0);
+    updateWorkerPoolUse();
+
+    for (auto& group : floatChain.groups)
+        group->oversampler->reset();
+
+    for (auto& group : doubleChain.groups)
+        group->oversampler->reset();
 }
 
 #ifndef JucePlugin_PreferredChannelConfigurations
@@ -160,12 +583,13 @@ bool DREKAVACAudioProcessor::isBusesLayoutSupported(const BusesLayout& layouts)
     juce::ignoreUnused(layouts);
     return true;
 #else
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-        && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    // Any layout up to the widest bed; channels are processed in independent pairs
+    const auto& output = layouts.getMainOutputChannelSet();
+    if (output.isDisabled() || output.size() > maxNumChannels)
         return false;
 
 #if ! JucePlugin_IsSynth
-    if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
+    if (output != layouts.getMainInputChannelSet())
         return false;
 #endif
 
@@ -176,77 +600,858 @@ bool DREKAVACAudioProcessor::isBusesLayoutSupported(const BusesLayout& layouts)
 
 //==============================================================================
 
+// First channels and samples of a preallocated scratch buffer
+template <typename SampleType>
+static juce::dsp::AudioBlock<SampleType> scratchBlock(juce::AudioBuffer<SampleType>& buffer, size_t numChannels, size_t numSamples)
+{
+    return juce::dsp::AudioBlock<SampleType>(buffer).getSubsetChannelBlock(0, numChannels).getSubBlock(0, numSamples);
+}
+
+// True when every channel stays under the threshold
+template <typename SampleType>
+static bool isSilent(const juce::AudioBuffer<SampleType>& buffer, float threshold)
+{
+    for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+        if (buffer.getMagnitude(ch, 0, buffer.getNumSamples()) >= (SampleType)threshold)
+            return false;
+
+    return true;
+}
+
+// dest *= gain, with the gain stepping linearly from startGain to endGain like a SmoothedValue
+template <typename SampleType>
+static void multiplyWithRamp(SampleType* dest, SampleType startGain, SampleType endGain, int numSamples)
+{
+    if (startGain == endGain)
+    {
+        juce::FloatVectorOperations::multiply(dest, startGain, numSamples);
+        return;
+    }
+
+    const SampleType step = (endGain - startGain) / (SampleType)numSamples;
+    for (int i = 0; i < numSamples; ++i)
+        dest[i] *= startGain + step * (SampleType)(i + 1);
+}
+
+// dest += source * gain, with the same ramp shape as multiplyWithRamp
+template <typename SampleType>
+static void addWithRamp(SampleType* dest, const SampleType* source, SampleType startGain, SampleType endGain, int numSamples)
+{
+    if (startGain == endGain)
+    {
+        juce::FloatVectorOperations::addWithMultiply(dest, source, startGain, numSamples);
+        return;
+    }
+
+    const SampleType step = (endGain - startGain) / (SampleType)numSamples;
+    for (int i = 0; i < numSamples; ++i)
+        dest[i] += source[i] * (startGain + step * (SampleType)(i + 1));
+}
+
+DREKAVACAudioProcessor::FlavorKernel DREKAVACAudioProcessor::getFlavorKernel() const noexcept
+{
+    if (flavorSmoothed.isSmoothing())
+        return FlavorKernel::blend;
+
+    const auto f = flavorSmoothed.getTargetValue();
+    return f == 0.0f ? FlavorKernel::distOnly : f == 1.0f ? FlavorKernel::foldOnly : FlavorKernel::blend;
+}
+
+DREKAVACAudioProcessor::MixKernel DREKAVACAudioProcessor::getMixKernel() const noexcept
+{
+    if (dryWetSmoothed.isSmoothing())
+        return MixKernel::blend;
+
+    const auto w = dryWetSmoothed.getTargetValue();
+    return w == 0.0f ? MixKernel::dryOnly : w == 1.0f ? MixKernel::wetOnly : MixKernel::blend;
+}
+
+DREKAVACAudioProcessor::BlockRamps DREKAVACAudioProcessor::takeBlockRamps(int numSamples, int oversamplingFactor)
+{
+    BlockRamps ramps;
+
+    // Kernels are picked before the ramps advance, so a ramp ending in this block still blends
+    ramps.flavorKernel = getFlavorKernel();
+    ramps.mixKernel = getMixKernel();
+
+    // Flavor is applied oversampled, the rest at the original rate
+    ramps.flavorStart = flavorSmoothed.getCurrentValue();
+    ramps.flavorEnd = flavorSmoothed.skip(numSamples * oversamplingFactor);
+    ramps.dryWetStart = dryWetSmoothed.getCurrentValue();
+    ramps.dryWetEnd = dryWetSmoothed.skip(numSamples);
+    ramps.gainStart = outputGainSmoothed.getCurrentValue();
+    ramps.gainEnd = outputGainSmoothed.skip(numSamples);
+
+    return ramps;
+}
+
+template <typename Math, DREKAVACAudioProcessor::FlavorKernel Flavor, typename SampleType>
+void DREKAVACAudioProcessor::processChain(ChannelGroup<SampleType>& group, juce::dsp::AudioBlock<SampleType>& oversampledBlock,
+                                          const BlockRamps& ramps)
+{
+    using Context = juce::dsp::ProcessContextReplacing<SampleType>;
+    const SampleType preGain = (SampleType)0.6;
+    const SampleType one = 1;
+
+    constexpr bool useDist = Flavor != FlavorKernel::foldOnly;
+    constexpr bool useFold = Flavor != FlavorKernel::distOnly;
+
+    const auto numChannels = oversampledBlock.getNumChannels();
+    const auto numSamples = oversampledBlock.getNumSamples();
+    jassert((int)numSamples <= group.distBuffer.getNumSamples());
+
+    auto distBlock = scratchBlock(group.distBuffer, numChannels, numSamples);
+    auto foldBlock = scratchBlock(group.foldBuffer, numChannels, numSamples);
+
+    oversampledBlock.multiplyBy(preGain);
+
+    // Each stage runs over the whole block before the next one starts
+    group.overdrive.template process<Math>(Context(oversampledBlock));
+
+    // A stage that sat out comes back from a clean state, under a ramp from zero
+    if constexpr (useDist)
+    {
+        if (std::exchange(group.distPathIdle, false))
+            group.dist.reset();
+
+        distBlock.copyFrom(oversampledBlock);
+        group.dist.template process<Math>(Context(distBlock));
+    }
+    else
+    {
+        group.distPathIdle = true;
+    }
+
+    if constexpr (useFold)
+    {
+        if (std::exchange(group.foldPathIdle, false))
+            group.fold.reset();
+
+        foldBlock.copyFrom(oversampledBlock);
+        group.fold.template process<Math>(Context(foldBlock));
+    }
+    else
+    {
+        group.foldPathIdle = true;
+    }
+
+    if constexpr (Flavor == FlavorKernel::blend)
+    {
+        // Block-rate ramp for the flavor blend; every channel gets the same ramp
+        const SampleType f0 = ramps.flavorStart, f1 = ramps.flavorEnd;
+
+        for (size_t ch = 0; ch < numChannels; ++ch)
+        {
+            auto* od = oversampledBlock.getChannelPointer(ch);
+
+            // Parallel sum: od + dist * (1 - f) + fold * f
+            addWithRamp(od, distBlock.getChannelPointer(ch), one - f0, one - f1, (int)numSamples);
+            addWithRamp(od, foldBlock.getChannelPointer(ch), f0, f1, (int)numSamples);
+        }
+    }
+    else
+    {
+        // Flavor resting at an end: od + dist, or od + fold
+        auto& stageBlock = useDist ? distBlock : foldBlock;
+        oversampledBlock.add(stageBlock);
+    }
+}
+
+template <typename Math, DREKAVACAudioProcessor::FlavorKernel Flavor, typename SampleType>
+void DREKAVACAudioProcessor::processChainFused(ChannelGroup<SampleType>& group, juce::dsp::AudioBlock<SampleType>& oversampledBlock,
+                                               const BlockRamps& ramps)
+{
+    using Lanes = StereoLanes<SampleType>;
+    const SampleType preGain = (SampleType)0.6;
+    const SampleType one = 1;
+
+    constexpr bool useDist = Flavor != FlavorKernel::foldOnly;
+    constexpr bool useFold = Flavor != FlavorKernel::distOnly;
+
+    // A stage that sat out comes back from a clean state, under a ramp from zero
+    if constexpr (useDist)
+    {
+        if (std::exchange(group.distPathIdle, false))
+            group.dist.reset();
+    }
+    else
+    {
+        group.distPathIdle = true;
+    }
+
+    if constexpr (useFold)
+    {
+        if (std::exchange(group.foldPathIdle, false))
+            group.fold.reset();
+    }
+    else
+    {
+        group.foldPathIdle = true;
+    }
+
+    // Flavor gains ramp exactly as addWithRamp() steps them in the reference path
+    const SampleType f0 = ramps.flavorStart, f1 = ramps.flavorEnd;
+    const auto numSamples = (SampleType)oversampledBlock.getNumSamples();
+    const SampleType distStart = one - f0, distStep = ((one - f1) - distStart) / numSamples;
+    const SampleType foldStart = f0, foldStep = (f1 - f0) / numSamples;
+    int i = 0;
+
+    processLanes<Lanes>(oversampledBlock, [&](const Lanes& x)
+        {
+            const auto od = group.overdrive.template processNextSample<Math>(x * preGain);
+
+            if constexpr (Flavor == FlavorKernel::blend)
+            {
+                // Parallel sum: od + dist * (1 - f) + fold * f
+                const auto n = (SampleType)++i;
+                const auto wet = od + group.dist.template processNextSample<Math>(od) * (distStart + distStep * n);
+                return wet + group.fold.template processNextSample<Math>(od) * (foldStart + foldStep * n);
+            }
+            else if constexpr (useDist)
+            {
+                return od + group.dist.template processNextSample<Math>(od);
+            }
+            else
+            {
+                return od + group.fold.template processNextSample<Math>(od);
+            }
+        });
+
+    if constexpr (useDist)
+        group.dist.finishSweep();
+}
+
+template <typename Math, DREKAVACAudioProcessor::MixKernel Mix, typename SampleType>
+void DREKAVACAudioProcessor::processOutputStage(ChannelGroup<SampleType>& group, juce::dsp::AudioBlock<SampleType>& block,
+                                                const BlockRamps& ramps)
+{
+    using Lanes = StereoLanes<SampleType>;
+    const SampleType one = 1;
+
+    const auto numChannels = block.getNumChannels();
+    const auto numSamples = block.getNumSamples();
+    auto dryBlock = scratchBlock(group.dryBuffer, numChannels, numSamples);
+
+    const SampleType w0 = ramps.dryWetStart, w1 = ramps.dryWetEnd;
+    const SampleType g0 = ramps.gainStart, g1 = ramps.gainEnd;
+
+    if constexpr (Mix == MixKernel::dryOnly)
+    {
+        // Nothing of the wet path is heard, so the delayed dry signal is the output
+        block.copyFrom(dryBlock);
+    }
+    else
+    {
+        //Tone filtering
+        group.toneProcessor.process(juce::dsp::ProcessContextReplacing<SampleType>(block));
+    }
+
+    for (size_t ch = 0; ch < numChannels; ++ch)
+    {
+        auto* wet = block.getChannelPointer(ch);
+
+        // Dry/wet, then output gain
+        if constexpr (Mix == MixKernel::blend)
+        {
+            multiplyWithRamp(wet, w0, w1, (int)numSamples);
+            addWithRamp(wet, dryBlock.getChannelPointer(ch), one - w0, one - w1, (int)numSamples);
+        }
+
+        multiplyWithRamp(wet, g0, g1, (int)numSamples);
+    }
+
+    //Final soft clip at the original rate; see the "clipadaa" switch for what ADAA trades
+    auto& clipper = group.outputClipper;
+    if (group.outputClipADAA)
+        processLanes<Lanes>(block, [&clipper](const Lanes& x) { return clipper.template process<Math>(x); });
+    else
+        processLanes<Lanes>(block, [](const Lanes& x) { return Math::tanh(x); });
+}
+
+template <typename Math, typename SampleType>
+void DREKAVACAudioProcessor::processStages(ChannelGroup<SampleType>& group, juce::dsp::AudioBlock<SampleType>& block,
+                                           const BlockRamps& ramps, bool timeStages)
+{
+    const auto numChannels = block.getNumChannels();
+    const auto numSamples = block.getNumSamples();
+    jassert((int)numSamples <= group.dryBuffer.getNumSamples());
+
+    auto endStage = [this, timeStages](ProcessingStats::Stage stage)
+        {
+            if (timeStages)
+                processingMeter.endStage(stage);
+        };
+
+    // Keep the clean input for the dry/wet mix, delayed by the oversampler latency.
+    // This runs for every kernel, so the delay is already full when the mix moves.
+    auto dryBlock = scratchBlock(group.dryBuffer, numChannels, numSamples);
+    for (size_t ch = 0; ch < numChannels; ++ch)
+    {
+        const auto* in = block.getChannelPointer(ch);
+        auto* dry = dryBlock.getChannelPointer(ch);
+
+        for (size_t i = 0; i < numSamples; ++i)
+        {
+            group.dryDelay.pushSample((int)ch, in[i]);
+            dry[i] = group.dryDelay.popSample((int)ch);
+        }
+    }
+
+    if (ramps.mixKernel == MixKernel::dryOnly)
+    {
+        // Fully dry: the oversampled section would only be thrown away
+        group.wetPathIdle = true;
+        for (auto stage : { ProcessingStats::upsample, ProcessingStats::chain, ProcessingStats::downsample })
+            endStage(stage);
+
+        processOutputStage<Math, MixKernel::dryOnly>(group, block, ramps);
+    }
+    else
+    {
+        // Coming back from fully dry, the wet path restarts from silence
+        if (std::exchange(group.wetPathIdle, false))
+        {
+            group.oversampler->reset();
+            group.overdrive.reset();
+            group.dist.reset();
+            group.fold.reset();
+            group.toneProcessor.reset();
+            group.distPathIdle = group.foldPathIdle = false;
+        }
+
+        //Upsample
+        juce::dsp::AudioBlock<SampleType> oversampledBlock;
+        {
+            DREKAVAC_TRACE_SCOPE("upsample");
+            oversampledBlock = group.oversampler->processSamplesUp(block);
+        }
+        endStage(ProcessingStats::upsample);
+
+        // Nonlinear stages at the oversampled rate
+        if (useFusedKernel.load(std::memory_order_relaxed))
+        {
+            switch (ramps.flavorKernel)
+            {
+                case FlavorKernel::distOnly: processChainFused<Math, FlavorKernel::distOnly>(group, oversampledBlock, ramps); break;
+                case FlavorKernel::foldOnly: processChainFused<Math, FlavorKernel::foldOnly>(group, oversampledBlock, ramps); break;
+                case FlavorKernel::blend:    processChainFused<Math, FlavorKernel::blend>(group, oversampledBlock, ramps);    break;
+            }
+        }
+        else
+        {
+            switch (ramps.flavorKernel)
+            {
+                case FlavorKernel::distOnly: processChain<Math, FlavorKernel::distOnly>(group, oversampledBlock, ramps); break;
+                case FlavorKernel::foldOnly: processChain<Math, FlavorKernel::foldOnly>(group, oversampledBlock, ramps); break;
+                case FlavorKernel::blend:    processChain<Math, FlavorKernel::blend>(group, oversampledBlock, ramps);    break;
+            }
+        }
+        endStage(ProcessingStats::chain);
+
+        //Downsample
+        {
+            DREKAVAC_TRACE_SCOPE("downsample");
+            group.oversampler->processSamplesDown(block);
+        }
+        endStage(ProcessingStats::downsample);
+
+        // Linear stages and the final clip at the original rate
+        if (ramps.mixKernel == MixKernel::wetOnly)
+            processOutputStage<Math, MixKernel::wetOnly>(group, block, ramps);
+        else
+            processOutputStage<Math, MixKernel::blend>(group, block, ramps);
+    }
+
+    //Output compressor, at the original rate
+    group.simpleComp.process(juce::dsp::ProcessContextReplacing<SampleType>(block));
+    endStage(ProcessingStats::output);
+}
+
+template <typename Math, typename SampleType>
+void DREKAVACAudioProcessor::processGroups(ChainState<SampleType>& chain, juce::dsp::AudioBlock<SampleType>& block,
+                                           const BlockRamps& ramps)
+{
+    const auto groupSize = StereoSample::size();
+    const auto numChannels = block.getNumChannels();
+    const auto numGroups = (int)juce::jmin(chain.groups.size(), (numChannels + groupSize - 1) / groupSize);
+
+    // Per-stage times only make sense when a single group runs on this thread
+    const bool timeStages = numGroups == 1;
+
+    // Worker threads run this too, so each job marks its own thread
+    auto processGroup = [&](int index)
+        {
+            DREKAVAC_REALTIME_SCOPE("processGroup");
+
+            const auto firstChannel = (size_t)index * groupSize;
+            auto groupBlock = block.getSubsetChannelBlock(firstChannel, juce::jmin(groupSize, numChannels - firstChannel));
+            processStages<Math>(*chain.groups[(size_t)index], groupBlock, ramps, timeStages);
+        };
+
+    if (timeStages)
+    {
+        processGroup(0);
+        return;
+    }
+
+    // Wide buses report the whole pass as chain time
+    processingMeter.endStage(ProcessingStats::upsample);
+
+    // With no workers started, or another instance using them, run() does the groups here
+    if (activeParameters.parallel)
+        workerPool->run(numGroups, processGroup);
+    else
+        for (int i = 0; i < numGroups; ++i)
+            processGroup(i);
+
+    processingMeter.endStage(ProcessingStats::chain);
+    processingMeter.endStage(ProcessingStats::downsample);
+}
+
 void DREKAVACAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer&)
 {
+    processBuffer(buffer);
+}
+
+void DREKAVACAudioProcessor::processBlock(juce::AudioBuffer<double>& buffer, juce::MidiBuffer&)
+{
+    processBuffer(buffer);
+}
+
+template <typename SampleType>
+void DREKAVACAudioProcessor::processBuffer(juce::AudioBuffer<SampleType>& buffer)
+{
+    DREKAVAC_TRACE_SCOPE("processBlock");
+    DREKAVAC_REALTIME_SCOPE("processBlock");
+
     juce::ScopedNoDenormals noDenormals;
 
+    auto& chain = getChain<SampleType>();
+    jassert(!chain.groups.empty()); // prepared for the other precision?
+
     auto totalNumInputChannels = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
 
+    processingMeter.beginBlock();
+
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear(i, 0, buffer.getNumSamples());
 
-    //Upsample
-    auto block = juce::dsp::AudioBlock<float>(buffer);
-    auto oversampledBlock = oversampler.processSamplesUp(block);
+    meterFeed.captureInput(buffer, totalNumInputChannels);
 
-    //Get parameter values
-    float drive = *parameters.getRawParameterValue("drive");
-    float tone = *parameters.getRawParameterValue("tone");
-    float distortion = *parameters.getRawParameterValue("distortion");
-    float cutoff = *parameters.getRawParameterValue("cutoff");   // 0..1 slider
-    float foldDepth = *parameters.getRawParameterValue("fold");
-    float flavor = *parameters.getRawParameterValue("flavor");
-    float outputGain = *parameters.getRawParameterValue("output");
-    float drywet = *parameters.getRawParameterValue("drywet");
+    // Offline the wall clock has nothing to do with the timeline, so changes land on the first sample
+    audioThreadID.store(juce::Thread::getCurrentThreadId(), std::memory_order_relaxed);
+    automation.beginBlock(buffer.getNumSamples(), getSampleRate(), !isNonRealtime());
 
-    //Pre-calculate expensive operations
-    float f = std::sin(flavor * juce::MathConstants<float>::halfPi);
-    float w = std::sqrt(drywet);
+    bypassed = false;
+
+    // Idle: nothing is left ringing, so silent input needs no processing at all.
+    // A pending oversampler swap still goes through the normal path.
+    const bool inputSilent = isSilent(buffer, silenceThreshold);
+    if (inputSilent && silentSamples >= getSilenceTailSamples()
+        && chain.pendingOversamplers.load(std::memory_order_acquire) == nullptr)
+    {
+        applySkippedAutomation(chain);
+        chainSkipped = true;
+
+        buffer.clear();
+        meterFeed.captureOutput(buffer, totalNumOutputChannels, getLatencySamples());
+        processingMeter.endBlock(buffer.getNumSamples(), getLatencySamples());
+        return;
+    }
+
+    // Back from idle or bypass: the dry delay and the wet path still hold audio
+    // from before, which would otherwise play out now
+    if (std::exchange(chainSkipped, false))
+    {
+        for (auto& group : chain.groups)
+        {
+            group->dryDelay.reset();
+            group->wetPathIdle = true;
+        }
+    }
+
+    // Adopt freshly built oversamplers, once the previous set has been collected.
+    // The block before the swap fades out on the old ones and the block after it
+    // fades in on the new ones, so the state reset and latency jump stay silent.
+    bool fadeOut = false, fadeIn = false;
+
+    if (chain.retiredOversamplers.load(std::memory_order_acquire) == nullptr
+        && chain.pendingOversamplers.load(std::memory_order_acquire) != nullptr)
+    {
+        if (!fadedOutForSwap)
+        {
+            fadeOut = true;
+            fadedOutForSwap = true;
+        }
+        else if (auto* next = chain.pendingOversamplers.exchange(nullptr, std::memory_order_acq_rel))
+        {
+            // Swapped in place, so the set going back holds the old oversamplers
+            // and nothing is allocated or freed here
+            jassert(next->size() == chain.groups.size());
+            for (size_t i = 0; i < chain.groups.size(); ++i)
+                std::swap(chain.groups[i]->oversampler, (*next)[i]);
+
+            chain.retiredOversamplers.store(next, std::memory_order_release);
+            prepareOversampledStages(chain);
+
+            for (auto& group : chain.groups)
+            {
+                group->dryDelay.setDelay(getDryDelay(chain));
+                group->simpleComp.setLookaheadSamples(getLookaheadSamples());
+            }
+
+            fadeIn = true;
+            fadedOutForSwap = false;
+        }
+    }
+
+    // Render quality gets the reference math and tighter coefficient tracking,
+    // realtime playback the fast tier, analytic or table-driven
+    const bool renderQuality = useRenderQuality();
+    const auto interval = renderQuality ? renderCoefficientUpdateInterval : coefficientUpdateInterval;
+    for (auto& group : chain.groups)
+        group->toneProcessor.setCoefficientUpdateInterval(interval);
+
+    auto block = juce::dsp::AudioBlock<SampleType>(buffer).getSubsetChannelBlock(
+        0, (size_t)juce::jmin(buffer.getNumChannels(), chain.numChannels));
+
+    const auto oversamplingFactor = (int)chain.groups.front()->oversampler->getOversamplingFactor();
+
+    // The chain only ever sees fixed slices of the host buffer, so its buffers are
+    // sized for one slice whatever the host sends. A slice is cut again wherever a
+    // queued GUI change was placed, and parameters and ramps are taken per piece;
+    // AutomationQueue explains how roughly those places follow the real timing.
+    int position = 0;
+    forEachSubBlock(block, (size_t)internalBlockSize, [&](juce::dsp::AudioBlock<SampleType>& slice)
+        {
+            const int sliceStart = position;
+            const int sliceEnd = sliceStart + (int)slice.getNumSamples();
+
+            while (position < sliceEnd)
+            {
+                refreshParameters(chain, position);
+                const int end = automation.getNextSplit(sliceEnd);
+
+                auto subBlock = slice.getSubBlock((size_t)(position - sliceStart), (size_t)(end - position));
+                const auto ramps = takeBlockRamps((int)subBlock.getNumSamples(), oversamplingFactor);
+
+                if (renderQuality)
+                    processGroups<RenderSaturation>(chain, subBlock, ramps);
+                else if (activeParameters.shaper == 1)
+                    processGroups<TableSaturation>(chain, subBlock, ramps);
+                else
+                    processGroups<RealtimeSaturation>(chain, subBlock, ramps);
+
+                position = end;
+            }
+        });
+
+    if (fadeOut)
+        buffer.applyGainRamp(0, buffer.getNumSamples(), 1, 0);
+    else if (fadeIn)
+        buffer.applyGainRamp(0, buffer.getNumSamples(), 0, 1);
+
+    // Count towards sleeping only while both ends are quiet
+    if (inputSilent && isSilent(buffer, silenceThreshold))
+        silentSamples = juce::jmin(silentSamples + buffer.getNumSamples(), std::numeric_limits<int>::max() / 2);
+    else
+        silentSamples = 0;
+
+    meterFeed.captureOutput(buffer, totalNumOutputChannels, getLatencySamples());
+
+    processingMeter.endStage(ProcessingStats::output);
+    processingMeter.endBlock(buffer.getNumSamples(), getLatencySamples());
+}
+
+void DREKAVACAudioProcessor::processBlockBypassed(juce::AudioBuffer<float>& buffer, juce::MidiBuffer&)
+{
+    processBypassedBuffer(buffer);
+}
+
+void DREKAVACAudioProcessor::processBlockBypassed(juce::AudioBuffer<double>& buffer, juce::MidiBuffer&)
+{
+    processBypassedBuffer(buffer);
+}
+
+template <typename SampleType>
+void DREKAVACAudioProcessor::processBypassedBuffer(juce::AudioBuffer<SampleType>& buffer)
+{
+    DREKAVAC_REALTIME_SCOPE("processBlockBypassed");
+
+    juce::ScopedNoDenormals noDenormals;
+
+    // Nothing to place while bypassed, but the changes still count
+    audioThreadID.store(juce::Thread::getCurrentThreadId(), std::memory_order_relaxed);
+    automation.beginBlock(buffer.getNumSamples(), getSampleRate(), false);
+
+    auto& chain = getChain<SampleType>();
+    applySkippedAutomation(chain);
+    chainSkipped = true;
+
+    auto& bypassDelay = chain.bypassDelay;
+
+    // Start from silence rather than whatever was left from the last bypass
+    if (!bypassed)
+    {
+        bypassDelay.reset();
+        bypassed = true;
+    }
+
+    bypassDelay.setDelay((SampleType)juce::jmin(getLatencySamples(), bypassDelay.getMaximumDelayInSamples()));
+
+    const int numChannels = juce::jmin(buffer.getNumChannels(), getTotalNumInputChannels(), chain.numChannels);
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        auto* data = buffer.getWritePointer(ch);
+
+        for (int i = 0; i < buffer.getNumSamples(); ++i)
+        {
+            bypassDelay.pushSample(ch, data[i]);
+            data[i] = bypassDelay.popSample(ch);
+        }
+    }
+
+    for (int ch = numChannels; ch < buffer.getNumChannels(); ++ch)
+        buffer.clear(ch, 0, buffer.getNumSamples());
+
+    // Leaving bypass always runs the chain again before it may sleep
+    silentSamples = 0;
+}
+
+double DREKAVACAudioProcessor::getTailLengthSeconds() const
+{
+    const double sampleRate = getSampleRate();
+    return decayTailSeconds + (sampleRate > 0.0 ? getLatencySamples() / sampleRate : 0.0);
+}
+
+int DREKAVACAudioProcessor::getSilenceTailSamples() const
+{
+    return getLatencySamples() + juce::roundToInt(decayTailSeconds * getSampleRate());
+}
+
+DREKAVACAudioProcessor::ParameterSnapshot DREKAVACAudioProcessor::captureParameters() const noexcept
+{
+    ParameterSnapshot p;
+    p.drive = paramValues.drive->load();
+    p.tone = paramValues.tone->load();
+    p.distortion = paramValues.distortion->load();
+    p.cutoff = paramValues.cutoff->load();
+    p.fold = paramValues.fold->load();
+    p.flavor = paramValues.flavor->load();
+    p.output = paramValues.output->load();
+    p.drywet = paramValues.drywet->load();
+    p.shaper = (int)paramValues.shaper->load();
+    p.driveADAA = paramValues.driveADAA->load() >= 0.5f;
+    p.distADAA = paramValues.distADAA->load() >= 0.5f;
+    p.foldADAA = paramValues.foldADAA->load() >= 0.5f;
+    p.clipADAA = paramValues.clipADAA->load() >= 0.5f;
+    p.compressor = paramValues.compressor->load() >= 0.5f;
+    p.parallel = paramValues.parallel->load() >= 0.5f;
+    return p;
+}
+
+template <typename Lookup>
+DREKAVACAudioProcessor::ParameterSnapshot DREKAVACAudioProcessor::makeSnapshot(Lookup&& value)
+{
+    ParameterSnapshot p;
+    p.drive = value("drive");
+    p.tone = value("tone");
+    p.distortion = value("distortion");
+    p.cutoff = value("cutoff");
+    p.fold = value("fold");
+    p.flavor = value("flavor");
+    p.output = value("output");
+    p.drywet = value("drywet");
+    p.shaper = (int)value("shaper");
+    p.driveADAA = value("driveadaa") >= 0.5f;
+    p.distADAA = value("distadaa") >= 0.5f;
+    p.foldADAA = value("foldadaa") >= 0.5f;
+    p.clipADAA = value("clipadaa") >= 0.5f;
+    p.compressor = value("compressor") >= 0.5f;
+    p.parallel = value("parallel") >= 0.5f;
+    return p;
+}
+
+DREKAVACAudioProcessor::ParameterSnapshot DREKAVACAudioProcessor::snapshotFromState(const juce::ValueTree& state) const
+{
+    // Same lookup replaceState() does: a PARAM child per ID, or the default when it is missing
+    return makeSnapshot([this, &state](const char* parameterID)
+        {
+            const auto child = state.getChildWithProperty("id", parameterID);
+            if (child.isValid() && child.hasProperty("value"))
+                return (float)child.getProperty("value");
+
+            auto* parameter = parameters.getParameter(parameterID);
+            return parameter->convertFrom0to1(parameter->getDefaultValue());
+        });
+}
+
+void DREKAVACAudioProcessor::applyValues(const float* values)
+{
+    const juce::ScopedLock sl(stateWriteLock);
+
+    // Same hand-off as applyState(), but the values are already parsed
+    presetSnapshot.write(makeSnapshot([values](const char* parameterID)
+        {
+            const auto found = std::find_if(parameterIDs.begin(), parameterIDs.end(),
+                                            [parameterID](const char* id) { return std::strcmp(id, parameterID) == 0; });
+            return values[std::distance(parameterIDs.begin(), found)];
+        }));
+    presetPending.store(true, std::memory_order_release);
+
+    // Through the host, so program changes are recorded like any other edit
+    for (size_t i = 0; i < parameterIDs.size(); ++i)
+        if (auto* parameter = parameters.getParameter(parameterIDs[i]))
+            parameter->setValueNotifyingHost(parameter->convertTo0to1(values[i]));
 
-    //Update DSP modules
-    overdrive.setDrive(drive);
-    overdrive.setTone(tone);
-    toneProcessor.setParameters(tone, drive);
-    dist.setPreGain(std::max(0.0f, distortion));
-    dist.setCutoffSliderValue(cutoff);
-    fold.setDepth(foldDepth);
+    presetPending.store(false, std::memory_order_release);
+    parameterVersion.fetch_add(1, std::memory_order_release);
+}
+
+void DREKAVACAudioProcessor::applyState(const juce::ValueTree& state)
+{
+    const juce::ScopedLock sl(stateWriteLock);
+
+    // Publish the whole preset first, then let replaceState() rewrite the live
+    // values parameter by parameter while the audio thread is holding the snapshot
+    presetSnapshot.write(snapshotFromState(state));
+    presetPending.store(true, std::memory_order_release);
 
-    // Use consistent oversampled rate
-    double oversampledRate = getSampleRate() * oversampler.getOversamplingFactor();
-    const float preGain = 0.6f;
+    parameters.replaceState(state);
 
-    int numSamples = oversampledBlock.getNumSamples();
+    // Back to the live values, which now match the snapshot
+    presetPending.store(false, std::memory_order_release);
+    parameterVersion.fetch_add(1, std::memory_order_release);
+}
 
-    for (int channel = 0; channel < totalNumInputChannels; ++channel)
+template <typename SampleType>
+void DREKAVACAudioProcessor::refreshParameters(ChainState<SampleType>& chain, int position)
+{
+    // A preset mid-load is applied whole, in the block that first sees it, and
+    // automation queued before it would only undo it
+    if (presetPending.load(std::memory_order_acquire))
     {
-        auto* channelData = oversampledBlock.getChannelPointer(channel);
+        automation.skipBlock();
 
-        for (int sample = 0; sample < numSamples; ++sample)
+        // A writer stalled mid-copy leaves the block on the values it had; the
+        // preset is still pending, so the next block tries again
+        ParameterSnapshot preset;
+        juce::uint32 sequence = 0;
+
+        if (presetSnapshot.tryRead(preset, sequence) && sequence != appliedPresetSequence)
         {
-            float inputSample = channelData[sample];
-            float scaledInput = inputSample * preGain;
+            appliedPresetSequence = sequence;
+            activeParameters = preset;
+            updateDspParameters(chain);
+        }
 
-            float odSample = overdrive.processSample(scaledInput, oversampledRate);
-            float distSample = dist.processSample(odSample);
-            float foldSample = fold.processSample(odSample);
+        return;
+    }
 
-            float parallel = odSample + distSample * (1.0f - f) + foldSample * f;
+    bool changed = false;
 
-            //Tone filtering
-            float filtered = toneProcessor.processSample(parallel);
+    // Only touch the stages when a listener saw something change, and only at
+    // block start; a change landing mid-block is caught next block
+    const auto version = parameterVersion.load(std::memory_order_acquire);
+    if (position == 0 && version != appliedParameterVersion)
+    {
+        auto live = captureParameters();
 
-            float mixed = inputSample * (1.0f - w) + filtered * w;
+        // A preset load or another change may have started while the values were
+        // read, leaving them half old and half new. Then this block keeps what it
+        // had and the next one reads again.
+        const bool torn = presetPending.load(std::memory_order_acquire)
+                       || parameterVersion.load(std::memory_order_acquire) != version;
 
-            mixed *= outputGain;
-            mixed = std::tanh(mixed);
+        if (!torn)
+        {
+            appliedParameterVersion = version;
 
-            channelData[sample] = mixed;
+            // Values automated in this block hold until their first change is due
+            for (int i = 0; i < ParameterSnapshot::numAutomatable; ++i)
+                if (automation.isAutomated(i))
+                    live.getAutomatable(i) = activeParameters.getAutomatable(i);
+
+            activeParameters = live;
+            changed = true;
         }
     }
 
-    //Downsample
-    oversampler.processSamplesDown(block);
+    changed |= automation.applyUpTo(position, [this](int index, float value)
+        {
+            activeParameters.getAutomatable(index) = value;
+        });
+
+    if (changed)
+        updateDspParameters(chain);
+}
+
+template <typename SampleType>
+void DREKAVACAudioProcessor::applySkippedAutomation(ChainState<SampleType>& chain)
+{
+    // A pending preset replaces these anyway, once the chain runs again
+    if (presetPending.load(std::memory_order_acquire))
+    {
+        automation.skipBlock();
+        return;
+    }
+
+    const bool changed = automation.applyUpTo(std::numeric_limits<int>::max(), [this](int index, float value)
+        {
+            activeParameters.getAutomatable(index) = value;
+        });
+
+    if (changed)
+        updateDspParameters(chain);
+}
+
+template <typename SampleType>
+void DREKAVACAudioProcessor::updateDspParameters(ChainState<SampleType>& chain)
+{
+    DREKAVAC_TRACE_SCOPE("updateDspParameters");
+
+    //Get parameter values
+    const auto& p = activeParameters;
+    float drive = p.drive;
+    float tone = p.tone;
+    float distortion = p.distortion;
+    float cutoff = p.cutoff;   // 0..1 slider
+    float foldDepth = p.fold;
+    float flavor = p.flavor;
+    float outputGain = p.output;
+    float drywet = p.drywet;
+
+    //Pre-calculate expensive operations
+    // Exact at the top end too, so the fold-only kernel can take over there
+    flavorSmoothed.setTargetValue(flavor >= 1.0f ? 1.0f : std::sin(flavor * juce::MathConstants<float>::halfPi));
+    dryWetSmoothed.setTargetValue(std::sqrt(drywet));
+    outputGainSmoothed.setTargetValue(outputGain);
+
+    //Update DSP modules, every group alike
+    for (auto& group : chain.groups)
+    {
+        group->overdrive.setDrive(drive);
+        group->overdrive.setTone(tone);
+        group->toneProcessor.setParameters(tone, drive);
+        group->dist.setPreGain(std::max(0.0f, distortion));
+        group->dist.setCutoffSliderValue(cutoff);
+        group->fold.setDepth(foldDepth);
+
+        group->overdrive.setAntialiasing(p.driveADAA);
+        group->dist.setAntialiasing(p.distADAA);
+        group->fold.setAntialiasing(p.foldADAA);
+
+        // ADAA switches and the flavor blend move the wet path's delay. Called from
+        // prepareChain before the line is sized, where it is set again once it is.
+        group->dryDelay.setDelay(juce::jmin(getDryDelay(chain), (SampleType)group->dryDelay.getMaximumDelayInSamples()));
+
+        // Primed afresh on the way in, like the stages' own switches
+        if (p.clipADAA && !group->outputClipADAA)
+            group->outputClipper.reset();
+        group->outputClipADAA = p.clipADAA;
+        group->simpleComp.setEnabled(p.compressor);
+    }
 }
 
 
@@ -255,22 +1460,70 @@ void DREKAVACAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce
 
 void DREKAVACAudioProcessor::getStateInformation(juce::MemoryBlock& destData)
 {
-    auto state = parameters.copyState();
-    std::unique_ptr<juce::XmlElement> xml(state.createXml());
-    copyXmlToBinary(*xml, destData);
+    DREKAVAC_TRACE_SCOPE("getStateInformation");
+
+    // Header, then every plain value in parameterIDs order, all little-endian
+    juce::MemoryOutputStream stream(destData, false);
+    stream.writeInt(stateMagic);
+    stream.writeShort(stateVersion);
+    stream.writeShort((short)parameterIDs.size());
+
+    for (auto* id : parameterIDs)
+        stream.writeFloat(parameters.getRawParameterValue(id)->load());
 }
 
 void DREKAVACAudioProcessor::setStateInformation(const void* data, int sizeInBytes)
 {
+    DREKAVAC_TRACE_SCOPE("setStateInformation");
+
+    if (sizeInBytes >= 8 && juce::ByteOrder::littleEndianInt(data) == (juce::uint32)stateMagic)
+    {
+        juce::MemoryInputStream stream(data, (size_t)sizeInBytes, false);
+        stream.readInt();
+        const auto version = stream.readShort();
+        const auto numStored = (int)(juce::uint16)stream.readShort();
+
+        if (version > stateVersion)
+            return;
+
+        // IDs are only ever appended, so an older state fills a prefix and the
+        // rest keep their defaults
+        std::array<float, parameterIDs.size()> values;
+        for (size_t i = 0; i < parameterIDs.size(); ++i)
+        {
+            auto* parameter = parameters.getParameter(parameterIDs[i]);
+
+            if ((int)i >= numStored || stream.getNumBytesRemaining() < 4)
+            {
+                values[i] = parameter->convertFrom0to1(parameter->getDefaultValue());
+                continue;
+            }
+
+            // A corrupt chunk is ignored whole rather than letting NaN into the
+            // stages; anything finite is pulled into range and onto a legal step
+            const auto value = stream.readFloat();
+            if (!std::isfinite(value))
+                return;
+
+            values[i] = parameter->convertFrom0to1(parameter->convertTo0to1(value));
+        }
+
+        applyValues(values.data());
+        return;
+    }
+
+    // Sessions saved before the binary format
     std::unique_ptr<juce::XmlElement> xml(getXmlFromBinary(data, sizeInBytes));
     if (xml != nullptr)
-        parameters.replaceState(juce::ValueTree::fromXml(*xml));
+        applyState(juce::ValueTree::fromXml(*xml));
 }
 
 //==============================================================================
 // Simple preset functions
 void DREKAVACAudioProcessor::savePresetToFile(const juce::File& file)
 {
+    DREKAVAC_TRACE_SCOPE("savePresetToFile");
+
     if (!file.hasFileExtension(".preset"))
         return;
 
@@ -279,11 +1532,16 @@ void DREKAVACAudioProcessor::savePresetToFile(const juce::File& file)
     {
         xml->setAttribute("presetName", currentPresetName);
         xml->writeTo(file);
+
+        if (file.isAChildOf(presetBank->getDirectory()))
+            presetBank->rescan();
     }
 }
 
 void DREKAVACAudioProcessor::loadPresetFromFile(const juce::File& file)
 {
+    DREKAVAC_TRACE_SCOPE("loadPresetFromFile");
+
     if (!file.existsAsFile())
         return;
 
@@ -291,18 +1549,84 @@ void DREKAVACAudioProcessor::loadPresetFromFile(const juce::File& file)
 
     if (xml && xml->hasTagName(parameters.state.getType()))
     {
-        parameters.replaceState(juce::ValueTree::fromXml(*xml));
+        applyState(juce::ValueTree::fromXml(*xml));
         currentPresetName = xml->getStringAttribute("presetName", "Unknown");
     }
 }
 
-void DREKAVACAudioProcessor::notifyUIUpdate()
+//==============================================================================
+// Programs come straight from the preset bank, so switching never reads a file
+int DREKAVACAudioProcessor::getNumPrograms()
+{
+    return presetBank->getNumPresets();
+}
+
+int DREKAVACAudioProcessor::getCurrentProgram()
+{
+    const auto pending = pendingProgram.load();
+    return pending >= 0 ? pending : currentProgram.load();
+}
+
+void DREKAVACAudioProcessor::setCurrentProgram(int index)
+{
+    // Applying a program locks and notifies the host once per parameter, so a
+    // call from any other thread, the audio thread included, is only noted here
+    // and applied on the next timer tick
+    pendingProgram.store(index);
+
+    if (juce::MessageManager::existsAndIsCurrentThread())
+        applyPendingProgram();
+}
+
+void DREKAVACAudioProcessor::applyPendingProgram()
+{
+    const auto index = pendingProgram.exchange(-1);
+    if (index < 0)
+        return;
+
+    std::array<float, parameterIDs.size()> values;
+    if (!presetBank->getValues(index, values.data()))
+        return;
+
+    applyValues(values.data());
+    currentProgram = index;
+    currentPresetName = presetBank->getName(index);
+
+    updateHostDisplay(juce::AudioProcessorListener::ChangeDetails().withProgramChanged(true));
+}
+
+void DREKAVACAudioProcessor::changeListenerCallback(juce::ChangeBroadcaster*)
+{
+    // Hosts re-read the program list once a scan lands
+    currentProgram = juce::jmin(currentProgram.load(), presetBank->getNumPresets() - 1);
+    updateHostDisplay(juce::AudioProcessorListener::ChangeDetails().withProgramChanged(true));
+}
+
+const juce::String DREKAVACAudioProcessor::getProgramName(int index)
+{
+    return presetBank->getName(index);
+}
+
+void DREKAVACAudioProcessor::setLiveMode(bool shouldBeLive)
 {
-    // This makes the host & GUI aware of parameter changes
-    if (auto* editor = dynamic_cast<DREKAVACAudioProcessorEditor*>(getActiveEditor()))
-        editor->repaint();
+    if (shouldBeLive == liveMode)
+        return;
 
-    updateHostDisplay();
+    liveMode = shouldBeLive;
+
+    for (size_t i = 0; i < liveModeIDs.size(); ++i)
+    {
+        auto* parameter = parameters.getParameter(liveModeIDs[i]);
+        if (parameter == nullptr)
+            continue;
+
+        if (shouldBeLive)
+            valuesBeforeLiveMode[i] = parameter->convertFrom0to1(parameter->getValue());
+
+        // Ordinary edits: the listener rebuilds the oversampler and reports the new latency
+        const auto value = shouldBeLive ? liveModeValues[i] : valuesBeforeLiveMode[i];
+        parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+    }
 }
 
 //==============================================================================
@@ -314,11 +1638,19 @@ juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter()
 
 bool DREKAVACAudioProcessor::hasEditor() const
 {
+#if DREKAVAC_HEADLESS
+    return false;
+#else
     return true; // plugin has an editor
+#endif
 }
 
 juce::AudioProcessorEditor* DREKAVACAudioProcessor::createEditor()
 {
+#if DREKAVAC_HEADLESS
+    return nullptr;
+#else
     return new DREKAVACAudioProcessorEditor(*this);
+#endif
 
 }
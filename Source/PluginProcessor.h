@@ -2,35 +2,80 @@
 
 #include <JuceHeader.h>
 #include <juce_dsp/juce_dsp.h>
-
+#include "SampleLanes.h"
+#include "SaturationMath.h"
+#include "ProcessingStats.h"
+#include "ChannelWorkerPool.h"
+#include "SeqLock.h"
+#include "PresetBank.h"
+#include "MeterFeed.h"
+#include "AutomationQueue.h"
+#include "SharedTables.h"
+#include "SharedOversampling.h"
+#include "Trace.h"
+#include "RealtimeCheck.h"
+
+// Ramp time shared by every smoothed parameter in the chain
+constexpr double parameterSmoothingSeconds = 0.02;
+
+// While a filter parameter ramps, coefficients are refreshed once per this many samples
+constexpr size_t coefficientUpdateInterval = 32;
+
+// Tighter interval used by the render quality mode
+constexpr size_t renderCoefficientUpdateInterval = 8;
+
+// Host buffers are cut into slices of at most this many samples before they reach
+// the chain, which bounds its working set and per-slice cost
+constexpr int internalBlockSize = 64;
+
+template <typename SampleType>
 class ToneProcessor
 {
 public:
+    using Lanes = StereoLanes<SampleType>;
+
     void prepare(double sampleRate)
     {
         fs = sampleRate;
-        updateCoefficients();
+        balanceSmoothed.reset(sampleRate, parameterSmoothingSeconds);
+        driveSmoothed.reset(sampleRate, parameterSmoothingSeconds);
+        updateCoefficients(balanceSmoothed.getTargetValue(), driveSmoothed.getTargetValue());
         lowFilter.reset();
         highFilter.reset();
     }
 
+    void setCoefficientUpdateInterval(size_t numSamples) { updateInterval = numSamples; }
+
     void setParameters(float toneSlider, float driveSlider)
     {
         // Keep tone slider linear 0–1
-        balance = juce::jlimit(0.0f, 1.0f, toneSlider);
-
-        // Drive subtly affects filter pivot and resonance
-        modulatedPivot = pivotFreq + driveSlider * 100.0f; // pivot 1 kHz -> ~2 kHz at max drive
-        modulatedQ = q + driveSlider * 0.05f;          // Q 0.707 -> ~1.2 at max drive
+        balanceSmoothed.setTargetValue(juce::jlimit(0.0f, 1.0f, toneSlider));
+        driveSmoothed.setTargetValue(driveSlider);
+    }
 
-        updateCoefficients();
+    Lanes processSample(const Lanes& input)
+    {
+        auto low = lowFilter.processSample(input);
+        auto high = highFilter.processSample(input);
+        return low + balance * (high - low);
     }
 
-    float processSample(float input)
+    void process(const juce::dsp::ProcessContextReplacing<SampleType>& context)
     {
-        float low = lowFilter.processSample(input);
-        float high = highFilter.processSample(input);
-        return juce::jmap(balance, low, high);
+        if (context.isBypassed)
+            return;
+
+        forEachSubBlock(context.getOutputBlock(), updateInterval, [this](juce::dsp::AudioBlock<SampleType>& subBlock)
+            {
+                // Shelves are only redesigned while a knob is ramping
+                if (balanceSmoothed.isSmoothing() || driveSmoothed.isSmoothing())
+                {
+                    const auto numSamples = (int)subBlock.getNumSamples();
+                    updateCoefficients(balanceSmoothed.skip(numSamples), driveSmoothed.skip(numSamples));
+                }
+
+                processLanes<Lanes>(subBlock, [this](const Lanes& x) { return processSample(x); });
+            });
     }
 
     void reset()
@@ -40,8 +85,13 @@ public:
     }
 
 private:
-    juce::dsp::IIR::Filter<float> lowFilter;
-    juce::dsp::IIR::Filter<float> highFilter;
+    // State variable shelves, so redesigning them mid-sweep never clicks
+    LaneSVF<Lanes> lowFilter;
+    LaneSVF<Lanes> highFilter;
+
+    juce::SmoothedValue<float> balanceSmoothed{ 0.5f };
+    juce::SmoothedValue<float> driveSmoothed;
+    size_t updateInterval = coefficientUpdateInterval;
 
     double fs = 44100.0;
     float balance = 0.5f;
@@ -54,160 +104,435 @@ private:
     float modulatedPivot = pivotFreq;
     float modulatedQ = q;
 
-    void updateCoefficients()
+    // Both shelves share the pivot, so one tan() covers the pair
+    void updateCoefficients(float newBalance, float driveSlider)
     {
-        auto lowShelf = juce::dsp::IIR::Coefficients<float>::makeLowShelf(
-            fs, modulatedPivot, modulatedQ, 1.0f + (1.0f - balance) * 1.5f);
+        balance = newBalance;
 
-        auto highShelf = juce::dsp::IIR::Coefficients<float>::makeHighShelf(
-            fs, modulatedPivot, modulatedQ, 1.0f + balance * 1.5f);
+        // Drive subtly affects filter pivot and resonance
+        modulatedPivot = pivotFreq + driveSlider * 100.0f; // pivot 1 kHz -> ~2 kHz at max drive
+        modulatedQ = q + driveSlider * 0.05f;              // Q 0.707 -> ~1.2 at max drive
 
-        lowFilter.coefficients = lowShelf;
-        highFilter.coefficients = highShelf;
+        const auto g = LaneSVF<Lanes>::warp(fs, modulatedPivot);
+        const auto k = SampleType(1) / (SampleType)modulatedQ;
+
+        lowFilter.setCoefficients(LaneSVF<Lanes>::makeLowShelf(g, k, (SampleType)(1.0f + (1.0f - balance) * 1.5f)));
+        highFilter.setCoefficients(LaneSVF<Lanes>::makeHighShelf(g, k, (SampleType)(1.0f + balance * 1.5f)));
     }
 };
 
+template <typename SampleType>
 class Overdrive
 {
 public:
-    Overdrive() : drive(1.0f), tone(0.5f), prevY(0.0f) {}
+    using Lanes = StereoLanes<SampleType>;
+
+    Overdrive() : driveSmoothed(1.0f), toneSmoothed(0.5f)
+    {
+        updateCoefficients(1.0f, 0.5f);
+    }
 
-    void setDrive(float d) { drive = d; }
-    void setTone(float t) { tone = juce::jlimit(0.0f, 1.0f, t); }
+    void setDrive(float d) { driveSmoothed.setTargetValue(d); }
+    void setTone(float t) { toneSmoothed.setTargetValue(juce::jlimit(0.0f, 1.0f, t)); }
 
-    float processSample(float input, double sampleRate)
+    // Antiderivative antialiasing on the clipper
+    void setAntialiasing(bool shouldUseADAA)
     {
+        if (shouldUseADAA != useADAA)
+            clipper.reset();
+        useADAA = shouldUseADAA;
+    }
+
+    void prepare(double sampleRate)
+    {
+        dt = SampleType(1) / (SampleType)sampleRate;
+        driveSmoothed.reset(sampleRate, parameterSmoothingSeconds);
+        toneSmoothed.reset(sampleRate, parameterSmoothingSeconds);
+        updateCoefficients(driveSmoothed.getCurrentValue(), toneSmoothed.getCurrentValue());
+        reset();
+    }
+
+    void reset()
+    {
+        prevY = {};
+        clipper.reset();
+    }
+
+    template <typename Math>
+    void process(const juce::dsp::ProcessContextReplacing<SampleType>& context)
+    {
+        if (context.isBypassed)
+            return;
+
+        if (useADAA)
+            processLanes<Lanes>(context.getOutputBlock(),
+                [this](const Lanes& x) { return processSample<Math, true>(x); });
+        else
+            processLanes<Lanes>(context.getOutputBlock(),
+                [this](const Lanes& x) { return processSample<Math, false>(x); });
+    }
+
+    // One sample with the current settings, for loops that fuse several stages
+    template <typename Math>
+    Lanes processNextSample(const Lanes& input)
+    {
+        return useADAA ? processSample<Math, true>(input) : processSample<Math, false>(input);
+    }
+
+    template <typename Math, bool Antialiased = false>
+    Lanes processSample(const Lanes& input)
+    {
+        // Gain and tone coefficient only move while their knobs ramp
+        if (driveSmoothed.isSmoothing() || toneSmoothed.isSmoothing())
+            updateCoefficients(driveSmoothed.getNextValue(), toneSmoothed.getNextValue());
+
         // input gain (gentle curve)
-        float x = input * (1.0f + std::pow(drive, 2.0f));
+        auto x = input * gain;
 
         // soft clipping
-        float y = std::tanh(x);
+        Lanes y;
+        if constexpr (Antialiased)
+            y = clipper.template process<Math>(x);
+        else
+            y = Math::tanh(x);
 
         // 1 pole lowpass for tone (0 - darker, 1 - brighter)
-        float cutoff = 200.0f + tone * 8000.0f; // 200..8200 Hz
-        float RC = 1.0f / (2.0f * juce::MathConstants<float>::pi * cutoff);
-        float dt = 1.0f / (float)sampleRate;
-        float alpha = dt / (RC + dt);
-
         prevY = prevY + alpha * (y - prevY);
         return prevY;
     }
 
 private:
-    float drive, tone;
-    float prevY;
+    void updateCoefficients(float drive, float tone)
+    {
+        gain = 1.0f + drive * drive;
+
+        SampleType cutoff = SampleType(200) + tone * SampleType(8000); // 200..8200 Hz
+        SampleType RC = SampleType(1) / (SampleType(2) * juce::MathConstants<SampleType>::pi * cutoff);
+        alpha = dt / (RC + dt);
+    }
+
+    juce::SmoothedValue<float> driveSmoothed, toneSmoothed;
+    SampleType dt = SampleType(1) / SampleType(44100);
+    float gain = 1.0f;
+    SampleType alpha = 0;
+    Lanes prevY;
+
+    bool useADAA = false;
+    AntiderivativeShaper<TanhShape, Lanes> clipper;
 };
 
+template <typename SampleType>
 class Distortion
 {
 public:
-    Distortion() : preGain(1.0f), sliderValue(0.2f), fs(44100.0)
+    using Lanes = StereoLanes<SampleType>;
+
+    Distortion() : preGainSmoothed(1.0f), sliderSmoothed(0.2f), sliderValue(0.2f), cutoff(sliderToCutoff(0.2f)), fs(44100.0)
     {
         updateFilter();
+        updatePostFilter();
     }
 
-    void setPreGain(float g) { preGain = g; }
+    void setPreGain(float g) { preGainSmoothed.setTargetValue(g); }
 
     // sliderValue expected 0.0 -> 1.0
-    void setCutoffSliderValue(float value)
+    void setCutoffSliderValue(float value) { sliderSmoothed.setTargetValue(juce::jlimit(0.0f, 1.0f, value)); }
+
+    // Antiderivative antialiasing on the pre clipper
+    void setAntialiasing(bool shouldUseADAA)
     {
-        sliderValue = juce::jlimit(0.0f, 1.0f, value);
+        if (shouldUseADAA != useADAA)
+            preClipper.reset();
+        useADAA = shouldUseADAA;
+    }
 
-        const float minHz = 100.0f;
-        const float maxHz = 8000.0f;
-        const float exponent = 0.7f; // gentle logarithmic response
-        cutoff = minHz * std::pow(maxHz / minHz, std::pow(sliderValue, exponent));
+    // Warped cutoffs (tan(pi f / fs)) across the slider range, so a sweep never
+    // calls pow() or tan() per sample. Only depends on the rate, so one table per
+    // rate is shared by every instance.
+    static constexpr int cutoffTableSize = 128;
+    using CutoffTable = std::array<SampleType, cutoffTableSize + 1>;
 
-        updateFilter();
+    static CutoffTable makeCutoffTable(double sampleRate)
+    {
+        CutoffTable table;
+        for (int i = 0; i <= cutoffTableSize; ++i)
+            table[(size_t)i] = LaneSVF<Lanes>::warp(sampleRate, sliderToCutoff((float)i / (float)cutoffTableSize));
+        return table;
     }
 
-    void prepare(double sampleRate)
+    // The table must be made for sampleRate and outlive the stage's use of it
+    void prepare(double sampleRate, const CutoffTable& table)
     {
         fs = sampleRate;
+        cutoffTable = &table;
+        preGainSmoothed.reset(sampleRate, parameterSmoothingSeconds);
+        sliderSmoothed.reset(sampleRate, parameterSmoothingSeconds);
+        updatePostFilter();
+        reset();
+
+        sliderValue = sliderSmoothed.getTargetValue();
+        cutoff = sliderToCutoff(sliderValue);
+        updateFilter();
+    }
+
+    void reset()
+    {
         for (auto& f : filters)
             f.reset();
-        juce::dsp::ProcessSpec spec{ sampleRate, 512, 1 };
-        for (auto& f : filters)
-            f.prepare(spec);
-        updateFilter();
+        postPrev = {};
+        preClipper.reset();
     }
 
-    float processSample(float input)
+    template <typename Math>
+    void process(const juce::dsp::ProcessContextReplacing<SampleType>& context)
+    {
+        if (context.isBypassed)
+            return;
+
+        auto& block = context.getOutputBlock();
+
+        if (sliderSmoothed.isSmoothing())
+        {
+            if (useADAA)
+                processBlock<Math, true, true>(block);
+            else
+                processBlock<Math, false, true>(block);
+        }
+        else if (useADAA)
+        {
+            processBlock<Math, true, false>(block);
+        }
+        else
+        {
+            processBlock<Math, false, false>(block);
+        }
+
+        finishSweep();
+    }
+
+    // One sample with the current settings, cutoff ramp included, for loops that
+    // fuse several stages. Call finishSweep() after the block.
+    template <typename Math>
+    Lanes processNextSample(const Lanes& input)
+    {
+        if (sliderSmoothed.isSmoothing())
+            setInterpolatedFilter(sliderSmoothed.getNextValue());
+
+        return useADAA ? processSample<Math, true>(input) : processSample<Math, false>(input);
+    }
+
+    // Once a cutoff ramp has landed, the resting value gets an exact design
+    void finishSweep()
+    {
+        if (filterInterpolated && !sliderSmoothed.isSmoothing())
+        {
+            sliderValue = sliderSmoothed.getTargetValue();
+            cutoff = sliderToCutoff(sliderValue);
+            updateFilter();
+        }
+    }
+
+    template <typename Math, bool Antialiased = false>
+    Lanes processSample(const Lanes& input)
     {
         //Pre soft clipping
-        float y = std::tanh(input * preGain);
+        Lanes y;
+        if constexpr (Antialiased)
+            y = preClipper.template process<Math>(input * preGainSmoothed.getNextValue());
+        else
+            y = Math::tanh(input * preGainSmoothed.getNextValue());
 
         //4 pole lowpass
         for (auto& f : filters)
             y = f.processSample(y);
 
         //1 pole post lowpass  @ ~10 kHz to reduce fizz
-        const float postCutoff = 10000.0f; // Hz
-        const float alpha = std::exp(-2.0f * juce::MathConstants<float>::pi * postCutoff / fs);
-        y = postPrev + (1.0f - alpha) * (y - postPrev);
+        y = postPrev + postGain * (y - postPrev);
         postPrev = y;
 
         //Final soft clipping for smooth output limiting
-        return std::tanh(y);
+        return Math::tanh(y);
     }
 
 private:
-    float preGain;
+    // While the cutoff ramps, every sample gets its own design from the table
+    template <typename Math, bool Antialiased, bool Sweeping>
+    void processBlock(juce::dsp::AudioBlock<SampleType>& block)
+    {
+        processLanes<Lanes>(block, [this](const Lanes& x)
+            {
+                if constexpr (Sweeping)
+                    setInterpolatedFilter(sliderSmoothed.getNextValue());
+
+                return processSample<Math, Antialiased>(x);
+            });
+    }
+
+    juce::SmoothedValue<float> preGainSmoothed;
+    juce::SmoothedValue<float> sliderSmoothed;
     float sliderValue; // 0..1 slider input
     float cutoff;
     double fs;
-    float postPrev = 0.0f;
+    Lanes postPrev;
 
-    // 2x 2 pole lowpass for 4 pole response
-    std::array<juce::dsp::IIR::Filter<float>, 2> filters;
+    static constexpr float postCutoff = 10000.0f; // Hz
+    SampleType postGain = 0; // 1 - alpha of the post lowpass
 
-    void updateFilter()
+    void updatePostFilter()
+    {
+        const SampleType alpha = (SampleType)std::exp(-2.0f * juce::MathConstants<float>::pi * postCutoff / fs);
+        postGain = 1.0f - alpha;
+    }
+
+    bool useADAA = false;
+    AntiderivativeShaper<TanhShape, Lanes> preClipper;
+
+    // 2x 2 pole lowpass for 4 pole response. State variable sections take a new
+    // cutoff every sample without clicking, which direct form biquads cannot.
+    std::array<LaneSVF<Lanes>, 2> filters;
+
+    const CutoffTable* cutoffTable = nullptr;
+
+    static float sliderToCutoff(float value)
+    {
+        const float minHz = 100.0f;
+        const float maxHz = 8000.0f;
+        const float exponent = 0.7f; // gentle logarithmic response
+        return minHz * std::pow(maxHz / minHz, std::pow(value, exponent));
+    }
+
+    static constexpr float filterQ = 0.707f;
+
+    bool filterInterpolated = false;
+
+    // Both sections share one design
+    void setFilter(SampleType g)
     {
-        const float Q = 0.707f;
-        auto coeffs = juce::dsp::IIR::Coefficients<float>::makeLowPass(fs, cutoff, Q);
+        const auto coeffs = LaneSVF<Lanes>::makeLowPass(g, SampleType(1) / (SampleType)filterQ);
         for (auto& f : filters)
-            f.coefficients = coeffs;
+            f.setCoefficients(coeffs);
+    }
+
+    void updateFilter()
+    {
+        setFilter(LaneSVF<Lanes>::warp(fs, cutoff));
+        filterInterpolated = false;
+    }
+
+    // Linear interpolation between neighbouring warped cutoffs
+    void setInterpolatedFilter(float value)
+    {
+        const float position = value * (float)cutoffTableSize;
+        const int index = juce::jlimit(0, cutoffTableSize - 1, (int)position);
+        const auto frac = (SampleType)(position - (float)index);
+
+        const auto lower = (*cutoffTable)[(size_t)index];
+        const auto upper = (*cutoffTable)[(size_t)index + 1];
+
+        setFilter(lower + frac * (upper - lower));
+        filterInterpolated = true;
     }
 };
 
 
 
+template <typename SampleType>
 class Wavefolder
 {
 public:
-    Wavefolder() : depth(0.0f) {}
+    using Lanes = StereoLanes<SampleType>;
+
+    Wavefolder() {}
 
     void setDepth(float d) {
-        depth = juce::jlimit(0.0f, 1.0f, std::pow(d, 1.5f));
+        depthSmoothed.setTargetValue(juce::jlimit(0.0f, 1.0f, std::pow(d, 1.5f)));
+    }
+
+    // Antiderivative antialiasing on the sine fold
+    void setAntialiasing(bool shouldUseADAA)
+    {
+        if (shouldUseADAA != useADAA)
+            folder.reset();
+        useADAA = shouldUseADAA;
     }
 
-    float processSample(float input)
+    void prepare(double sampleRate)
+    {
+        depthSmoothed.reset(sampleRate, parameterSmoothingSeconds);
+        reset();
+    }
+
+    void reset() { folder.reset(); }
+
+    template <typename Math>
+    void process(const juce::dsp::ProcessContextReplacing<SampleType>& context)
+    {
+        if (context.isBypassed)
+            return;
+
+        if (useADAA)
+            processLanes<Lanes>(context.getOutputBlock(),
+                [this](const Lanes& x) { return processSample<Math, true>(x); });
+        else
+            processLanes<Lanes>(context.getOutputBlock(),
+                [this](const Lanes& x) { return processSample<Math, false>(x); });
+    }
+
+    // One sample with the current settings, for loops that fuse several stages
+    template <typename Math>
+    Lanes processNextSample(const Lanes& input)
+    {
+        return useADAA ? processSample<Math, true>(input) : processSample<Math, false>(input);
+    }
+
+    template <typename Math, bool Antialiased = false>
+    Lanes processSample(const Lanes& input)
     {
+        const float depth = depthSmoothed.getNextValue();
+
         // Scale input with depth to get stronger folding at higher depths
-        float scaled = input * (1.0f + depth * 9.0f); // 1x -> 10x
-        float folded = std::sin(scaled * juce::MathConstants<float>::halfPi);
-        folded = std::tanh(folded);
+        auto scaled = input * (1.0f + depth * 9.0f); // 1x -> 10x
+
+        // The sine does the folding, so that is where the antialiasing goes;
+        // the tanh after it only ever sees +/-1
+        Lanes folded;
+        if constexpr (Antialiased)
+            folded = folder.template process<Math>(scaled * juce::MathConstants<SampleType>::halfPi);
+        else
+            folded = Math::sin(scaled * juce::MathConstants<SampleType>::halfPi);
+        folded = Math::tanh(folded);
         return input * (1.0f - depth) + folded * depth;
     }
 
 private:
-    float depth;
+    juce::SmoothedValue<float> depthSmoothed;
+
+    bool useADAA = false;
+    AntiderivativeShaper<SineShape, Lanes> folder;
 };
 
+template <typename SampleType>
 class SimpleCompressor
 {
 public:
+    using Lanes = StereoLanes<SampleType>;
+
+    // Longest lookahead prepare() reserves room for
+    static constexpr double lookaheadSeconds = 0.005;
+
     SimpleCompressor()
         : threshold(-3.0f),   // -3 dB, gentle limiting
         ratio(2.0f),        // mild compression
         knee(2.0f),         // small soft knee
         attackTime(0.005f), // 5 ms fast attack
         releaseTime(0.05f), // 50 ms release
-        sampleRate(44100.0),
-        envelope(0.0f)
+        sampleRate(44100.0)
     {
     }
 
+    static int getLookaheadSamples(double fs) { return (int)std::ceil(lookaheadSeconds * fs); }
+
+    // Allocates the lookahead line, so must be called off the audio thread
     void prepare(double fs)
     {
         sampleRate = fs;
@@ -215,19 +540,69 @@ public:
 
         attackCoeff = std::exp(-1.0f / (attackTime * sampleRate));
         releaseCoeff = std::exp(-1.0f / (releaseTime * sampleRate));
+
+        amountSmoothed.reset(fs, parameterSmoothingSeconds);
+
+        lookaheadBuffer.assign((size_t)getLookaheadSamples(fs), {});
+        setLookaheadSamples(lookaheadSamples);
     }
 
-    float processSample(float input)
+    // Fades the gain computer in and out; the lookahead delay stays either way,
+    // so toggling the compressor never changes latency
+    void setEnabled(bool shouldBeEnabled) { amountSmoothed.setTargetValue(shouldBeEnabled ? 1.0f : 0.0f); }
+
+    // Audio is delayed by this much while detection runs on the undelayed input
+    void setLookaheadSamples(int numSamples)
     {
+        lookaheadSamples = juce::jlimit(0, (int)lookaheadBuffer.size(), numSamples);
+        std::fill(lookaheadBuffer.begin(), lookaheadBuffer.end(), Lanes{});
+        writeIndex = 0;
+    }
+
+    size_t getHeapBytes() const noexcept { return lookaheadBuffer.capacity() * sizeof(Lanes); }
+
+    void process(const juce::dsp::ProcessContextReplacing<SampleType>& context)
+    {
+        if (context.isBypassed)
+            return;
+
+        // Fully off: only the lookahead delay is left to run
+        if (!amountSmoothed.isSmoothing() && amountSmoothed.getTargetValue() == 0.0f)
+        {
+            if (lookaheadSamples > 0)
+                processLanes<Lanes>(context.getOutputBlock(),
+                    [this](const Lanes& x) { return pushLookahead(x); });
+            return;
+        }
+
+        processLanes<Lanes>(context.getOutputBlock(),
+            [this](const Lanes& x) { return processSample(x); });
+    }
+
+    Lanes processSample(const Lanes& input)
+    {
+        // Stereo-linked detection: every channel follows the loudest one
+        float level = 0.0f;
+        for (size_t ch = 0; ch < Lanes::size(); ++ch)
+            level = std::max(level, (float)std::abs(input[ch]));
+
         // Simple 1 pole envelope follower
-        float level = std::fabs(input);
         if (level > envelope)
             envelope = attackCoeff * (envelope - level) + level;
         else
             envelope = releaseCoeff * (envelope - level) + level;
 
-        // Convert to dB
-        float levelDb = linearToDb(envelope);
+        const float gain = computeGain(envelope);
+        const float amount = amountSmoothed.getNextValue();
+
+        return pushLookahead(input) * (1.0f + amount * (gain - 1.0f));
+    }
+
+private:
+    // Gain computer in the log domain: levels in dB via fastLog2, gain back via fastExp2
+    float computeGain(float env) const
+    {
+        float levelDb = dbPerOctave * fastLog2(std::max(env, 1e-20f));
 
         // Soft knee gain reduction
         float gainDb = 0.0f;
@@ -245,11 +620,26 @@ public:
             gainDb = smooth * (threshold + (levelDb - threshold) / ratio - levelDb);
         }
 
-        float gain = dbToLinear(gainDb);
-        return input * gain;
+        return fastExp2(gainDb / dbPerOctave);
     }
 
-private:
+    Lanes pushLookahead(const Lanes& input)
+    {
+        if (lookaheadSamples == 0)
+            return input;
+
+        auto delayed = lookaheadBuffer[(size_t)writeIndex];
+        lookaheadBuffer[(size_t)writeIndex] = input;
+
+        if (++writeIndex >= lookaheadSamples)
+            writeIndex = 0;
+
+        return delayed;
+    }
+
+    // 20 * log10(2): dB per doubling of level
+    static constexpr float dbPerOctave = 6.0205999f;
+
     float threshold;
     float ratio;
     float knee;
@@ -257,24 +647,37 @@ private:
     float releaseTime;
 
     double sampleRate;
-    float envelope;
+    float envelope = 0.0f;
     float attackCoeff;
     float releaseCoeff;
 
-    // Lightweight conversions
-    static float dbToLinear(float db) { return std::pow(10.0f, db / 20.0f); }
-    static float linearToDb(float lin) { return 20.0f * std::log10(std::max(lin, 1e-20f)); }
+    juce::SmoothedValue<float> amountSmoothed;
+
+    std::vector<Lanes> lookaheadBuffer;
+    int lookaheadSamples = 0;
+    int writeIndex = 0;
 };
 
 
 //==============================================================================
 
-class DREKAVACAudioProcessor : public juce::AudioProcessor
+class DREKAVACAudioProcessor : public juce::AudioProcessor,
+                               private juce::Timer,
+                               private juce::ChangeListener
 {
 public:
     DREKAVACAudioProcessor();
     ~DREKAVACAudioProcessor() override;
 
+    // Every parameter ID, in the fixed order saved states store their values in.
+    // This is not the layout's order, and must never be reordered: new IDs are
+    // only ever appended.
+    static constexpr std::array<const char*, 19> parameterIDs{
+        "drive", "tone", "distortion", "cutoff", "fold", "flavor", "output", "drywet",
+        "oversampling", "osfilter", "quality", "compressor", "lookahead", "shaper",
+        "driveadaa", "distadaa", "foldadaa", "parallel", "clipadaa"
+    };
+
     // AudioProcessor overrides
     void prepareToPlay(double sampleRate, int samplesPerBlock) override;
     void releaseResources() override;
@@ -284,6 +687,14 @@ public:
 #endif
 
     void processBlock(juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlock(juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+
+    // Dry pass-through, delayed by the reported latency so bypassing never shifts the track
+    void processBlockBypassed(juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlockBypassed(juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+
+    // The whole chain is templated on sample type, so double buffers run natively
+    bool supportsDoublePrecisionProcessing() const override { return true; }
 
     juce::AudioProcessorEditor* createEditor() override;
     bool hasEditor() const override;
@@ -293,44 +704,442 @@ public:
     bool acceptsMidi() const override { return false; }
     bool producesMidi() const override { return false; }
     bool isMidiEffect() const override { return false; }
-    double getTailLengthSeconds() const override { return 0.0; }
 
-    int getNumPrograms() override { return 1; }
-    int getCurrentProgram() override { return 0; }
-    void setCurrentProgram(int) override {}
-    const juce::String getProgramName(int) override { return {}; }
+    // Auto quality follows this, so the oversampler is rebuilt when it flips
+    void setNonRealtime(bool isNonRealtime) noexcept override;
+    // Filter ring-out plus the latency, after which silent input gives silent output
+    double getTailLengthSeconds() const override;
+
+    // One program per preset in the bank, entry 0 being the defaults
+    int getNumPrograms() override;
+    int getCurrentProgram() override;
+    void setCurrentProgram(int index) override;
+    const juce::String getProgramName(int index) override;
     void changeProgramName(int, const juce::String&) override {}
 
+    // Compact binary state: 'DRKV', a version and the plain values. Older XML
+    // states are still read.
     void getStateInformation(juce::MemoryBlock& destData) override;
     void setStateInformation(const void* data, int sizeInBytes) override;
 
+    static constexpr int stateMagic = 0x564b5244; // "DRKV" read little-endian
+    static constexpr short stateVersion = 1;
+
     // convenience preset save/load
     void savePresetToFile(const juce::File& file);
     void loadPresetFromFile(const juce::File& file);
 
     juce::String getCurrentPresetName() const { return currentPresetName; }
 
-    void notifyUIUpdate();
+    PresetBank& getPresetBank() noexcept { return *presetBank; }
+
+    // Live mode for playing through the standalone: 1x oversampling with the IIR
+    // filter, realtime quality, no lookahead and ADAA on every stage, so the
+    // plugin adds no latency of its own. Leaving it puts the previous values back.
+    void setLiveMode(bool shouldBeLive);
+    bool isLiveMode() const noexcept { return liveMode; }
+
+    // Fused single-pass nonlinear kernel, on by default. The per-stage reference
+    // path stays selectable so the bench can compare cost and output.
+    void setFusedKernelEnabled(bool shouldUseFusedKernel) noexcept { useFusedKernel.store(shouldUseFusedKernel); }
+
+    // Latest processBlock timings, safe to call from any thread
+    ProcessingStats getProcessingStats() const { return processingMeter.getSnapshot(); }
+
+    // Levels and scope points, read by the editor's display at its frame rate
+    MeterFeed& getMeterFeed() noexcept { return meterFeed; }
+
+    // An estimate of what one instance keeps on the heap, worked out from the
+    // sizes of its buffers, delay lines and oversampler stages rather than
+    // measured; the parameter tree is not counted. The tables shared with other
+    // instances (the oversamplers' half-band designs, Distortion's cutoff curve,
+    // the shaper tables) are reported separately, once for the whole process.
+    struct MemoryFootprint
+    {
+        size_t instanceBytes = 0;
+        size_t sharedBytes = 0;
+        int numSharedTables = 0;
+        int numSharedTableBuilds = 0; // since the process started
+    };
+
+    // Message thread
+    MemoryFootprint getMemoryFootprint() const;
 
     // public APVTS for editor attachment
     juce::AudioProcessorValueTreeState parameters;
 
 private:
-    // DSP stages
-    Overdrive overdrive;
-    Distortion dist;
-    Wavefolder fold;
-    ToneProcessor toneProcessor;
-    SimpleCompressor simpleComp;
+    // Everything that carries audio for one pair of channels. Wider buses get one
+    // group per pair, each with its own state, so groups share nothing while they
+    // run and can be processed side by side.
+    template <typename SampleType>
+    struct ChannelGroup
+    {
+        using Oversampler = SharedOversampling<SampleType>;
+
+        // DSP stages
+        Overdrive<SampleType> overdrive;
+        Distortion<SampleType> dist;
+        Wavefolder<SampleType> fold;
+        ToneProcessor<SampleType> toneProcessor;
+        SimpleCompressor<SampleType> simpleComp;
+
+        // Final clip, at the original rate: plain tanh, or ADAA when the switch asks
+        AntiderivativeShaper<TanhShape, StereoLanes<SampleType>> outputClipper;
+        bool outputClipADAA = false;
+
+        // Dry signal held back by the wet path's delay, so the mix stays phase aligned.
+        // Thiran is an allpass, so the fractional part ADAA adds costs the dry no treble.
+        juce::dsp::DelayLine<SampleType, juce::dsp::DelayLineInterpolationTypes::Thiran> dryDelay;
 
+        // Preallocated scratch: dry at the original rate, parallel stages oversampled
+        juce::AudioBuffer<SampleType> dryBuffer, distBuffer, foldBuffer;
+
+        // Belongs to the audio thread; replacements arrive through ChainState
+        std::unique_ptr<Oversampler> oversampler;
+
+        // Sections a specialised kernel skipped, cleared before they are heard again
+        bool wetPathIdle = false, distPathIdle = false, foldPathIdle = false;
+    };
+
+    // The channel groups for one sample type. Only the chain for the precision the
+    // host asked for is prepared; the other one stays empty.
+    template <typename SampleType>
+    struct ChainState
+    {
+        using Group = ChannelGroup<SampleType>;
+
+        // One replacement oversampler per group, swapped in together
+        using OversamplerSet = std::vector<std::unique_ptr<typename Group::Oversampler>>;
+
+        ~ChainState() { release(); }
+
+        // Frees the groups and their oversamplers, for the chain that is not in use
+        void release()
+        {
+            groups.clear();
+            numChannels = 0;
+            cutoffTables = {};
+            delete pendingOversamplers.exchange(nullptr);
+            delete retiredOversamplers.exchange(nullptr);
+        }
+
+        std::vector<std::unique_ptr<Group>> groups;
+        int numChannels = 0;
+
+        // Shared Distortion tables for 1x, 2x, 4x and 8x at the prepared rate,
+        // all taken up front, so an oversampler swap never has to look one up
+        using CutoffTable = typename Distortion<SampleType>::CutoffTable;
+        std::array<std::shared_ptr<const CutoffTable>, 4> cutoffTables;
+
+        // Bypass path for the whole bus, sized for the worst-case latency
+        juce::dsp::DelayLine<SampleType, juce::dsp::DelayLineInterpolationTypes::None> bypassDelay;
+
+        // Replacements are built in timerCallback() and handed over through
+        // pendingOversamplers; the set they replace comes back through
+        // retiredOversamplers to be freed off the audio thread.
+        std::atomic<OversamplerSet*> pendingOversamplers{ nullptr };
+        std::atomic<OversamplerSet*> retiredOversamplers{ nullptr };
+    };
+
+    ChainState<float> floatChain;
+    ChainState<double> doubleChain;
+
+    template <typename SampleType>
+    ChainState<SampleType>& getChain() noexcept
+    {
+        if constexpr (std::is_same_v<SampleType, double>)
+            return doubleChain;
+        else
+            return floatChain;
+    }
+
+    // Mix gains, ramped across each block. Flavor runs oversampled, the rest at the original rate.
+    juce::SmoothedValue<float> flavorSmoothed, dryWetSmoothed, outputGainSmoothed;
+
+    bool bypassed = false;
+
+    // Set by blocks that skip the chain, idle or bypassed, so the next one that
+    // runs it clears what was left from before
+    bool chainSkipped = false;
+
+    // Idle detection: once input and output have been silent for a whole tail,
+    // processBlock stops running the chain until the input comes back
+    static constexpr double decayTailSeconds = 0.05;
+    static constexpr float silenceThreshold = 1.0e-6f; // -120 dB
+    int silentSamples = 0;
+
+    int getSilenceTailSamples() const;
+
+    // Per-block timing, published for the editor overlay and the bench tools
+    ProcessingMeter processingMeter;
+
+    // Levels and scope trace for the editor's meters
+    MeterFeed meterFeed;
+
+    std::atomic<bool> useFusedKernel{ true };
+
+    // Widest bus we prepare for; 9.1.6 and smaller beds fit
+    static constexpr int maxNumChannels = 16;
+
+    // Runs the channel groups of wide buses in parallel, one pool for the whole
+    // process. This instance only signs up for its threads while it is prepared
+    // with more than one group and Parallel Channels is on, so while nothing
+    // wants them no worker thread exists.
+    juce::SharedResourcePointer<ChannelWorkerPool> workerPool;
+    std::atomic<int> preparedNumGroups{ 0 }; // none while released
+    bool usingWorkerPool = false;
+    juce::CriticalSection workerPoolLock; // message-side callers only
+
+    // Signs up with the pool or leaves it, as the layout and the switch now say
+    void updateWorkerPoolUse();
+
+    // Raw APVTS values resolved once in the constructor, so the audio thread
+    // never looks a parameter up by its string ID
+    struct ParameterPointers
+    {
+        std::atomic<float>* drive = nullptr;
+        std::atomic<float>* tone = nullptr;
+        std::atomic<float>* distortion = nullptr;
+        std::atomic<float>* cutoff = nullptr;
+        std::atomic<float>* fold = nullptr;
+        std::atomic<float>* flavor = nullptr;
+        std::atomic<float>* output = nullptr;
+        std::atomic<float>* drywet = nullptr;
+        std::atomic<float>* oversampling = nullptr;
+        std::atomic<float>* osFilter = nullptr;
+        std::atomic<float>* quality = nullptr;
+        std::atomic<float>* compressor = nullptr;
+        std::atomic<float>* lookahead = nullptr;
+        std::atomic<float>* shaper = nullptr;
+        std::atomic<float>* driveADAA = nullptr;
+        std::atomic<float>* distADAA = nullptr;
+        std::atomic<float>* foldADAA = nullptr;
+        std::atomic<float>* clipADAA = nullptr;
+        std::atomic<float>* parallel = nullptr;
+    };
+
+    ParameterPointers paramValues;
+
+    // Every value the audio thread reads per block, taken together, so a block
+    // never runs on half of one state and half of another
+    struct ParameterSnapshot
+    {
+        float drive = 1.0f, tone = 0.5f, distortion = 1.0f, cutoff = 0.75f, fold = 0.2f;
+        float flavor = 0.5f, output = 1.0f, drywet = 0.5f;
+        int shaper = 0;
+        bool driveADAA = false, distADAA = false, foldADAA = false, clipADAA = false, compressor = false, parallel = true;
+
+        // The continuous values, which automation can move mid-block, indexed like
+        // the first numAutomatable entries of parameterIDs
+        static constexpr int numAutomatable = 8;
+
+        float& getAutomatable(int index) noexcept
+        {
+            float* const values[] = { &drive, &tone, &distortion, &cutoff, &fold, &flavor, &output, &drywet };
+            return *values[index];
+        }
+    };
+
+    // What the stages were last given; audio thread only
+    ParameterSnapshot activeParameters;
+
+    // Bumped by parameterChanged(), compared once per block
+    std::atomic<uint32_t> parameterVersion{ 0 };
+    uint32_t appliedParameterVersion = 0;
+
+    // Continuous changes made off the audio thread, placed on the block timeline
+    AutomationQueue automation;
+
+    // Whichever thread ran the last block, so its own changes are told apart
+    std::atomic<juce::Thread::ThreadID> audioThreadID{ nullptr };
+
+    // Preset and host state loads publish the complete new state here before the
+    // APVTS is touched. While presetPending is set the audio thread applies this
+    // snapshot whole and ignores the live values replaceState() is rewriting.
+    SeqLock<ParameterSnapshot> presetSnapshot;
+    std::atomic<bool> presetPending{ false };
+    juce::uint32 appliedPresetSequence = 0;
+    juce::CriticalSection stateWriteLock; // message-side writers only
+
+    // One listener per parameter, set up once, so a change arrives already
+    // knowing its index and nothing compares IDs on the way
+    struct ParameterListener : public juce::AudioProcessorValueTreeState::Listener
+    {
+        ParameterListener(DREKAVACAudioProcessor& p, int parameterIndex, bool movesOversampler)
+            : processor(p), index(parameterIndex), rebuildsOversampler(movesOversampler)
+        {
+        }
+
+        void parameterChanged(const juce::String&, float newValue) override
+        {
+            processor.parameterChanged(*this, newValue);
+        }
+
+        DREKAVACAudioProcessor& processor;
+        const int index;              // into parameterIDs
+        const bool rebuildsOversampler;
+    };
+
+    std::vector<std::unique_ptr<ParameterListener>> parameterListeners;
+
+    void parameterChanged(const ParameterListener& listener, float newValue);
+
+    ParameterSnapshot captureParameters() const noexcept;
+    ParameterSnapshot snapshotFromState(const juce::ValueTree& state) const;
+
+    // Builds a snapshot from any ID -> plain value lookup
+    template <typename Lookup>
+    static ParameterSnapshot makeSnapshot(Lookup&& value);
+
+    // Replaces the APVTS state so the audio thread sees the change in one step
+    void applyState(const juce::ValueTree& state);
+
+    // Same, from plain values in parameterIDs order, as the preset bank keeps them
+    void applyValues(const float* values);
+
+    // Picks up a committed preset or changed live values at block start, and
+    // automation falling due at later positions in the block
+    template <typename SampleType>
+    void refreshParameters(ChainState<SampleType>& chain, int position);
+
+    // Pushes activeParameters into the DSP stages as new ramp targets
+    template <typename SampleType>
+    void updateDspParameters(ChainState<SampleType>& chain);
+
+    // For blocks that skip the chain: their queued automation is applied whole,
+    // so the chain resumes on the latest values rather than losing the changes
+    template <typename SampleType>
+    void applySkippedAutomation(ChainState<SampleType>& chain);
+
+    // Builds the chain for one precision, called from prepareToPlay
+    template <typename SampleType>
+    void prepareChain(ChainState<SampleType>& chain, double sampleRate, int samplesPerBlock);
+
+    // Shared body of both processBlock and both processBlockBypassed overloads
+    template <typename SampleType>
+    void processBuffer(juce::AudioBuffer<SampleType>& buffer);
+
+    template <typename SampleType>
+    void processBypassedBuffer(juce::AudioBuffer<SampleType>& buffer);
+
+    // Kernel variants, picked once per block. With flavor or dry/wet resting at
+    // either end one side of the blend is silent, so it is not computed at all;
+    // while either ramp is moving the general blend runs.
+    enum class FlavorKernel { blend, distOnly, foldOnly };
+    enum class MixKernel { blend, wetOnly, dryOnly };
+
+    FlavorKernel getFlavorKernel() const noexcept;
+    MixKernel getMixKernel() const noexcept;
+
+    // Mix ramps and kernels for one block, taken once so every group sees the same
+    struct BlockRamps
+    {
+        FlavorKernel flavorKernel = FlavorKernel::blend;
+        MixKernel mixKernel = MixKernel::blend;
+        float flavorStart = 0.0f, flavorEnd = 0.0f;
+        float dryWetStart = 1.0f, dryWetEnd = 1.0f;
+        float gainStart = 1.0f, gainEnd = 1.0f;
+    };
+
+    BlockRamps takeBlockRamps(int numSamples, int oversamplingFactor);
+
+    // Runs every channel group, on the worker pool when that is enabled
+    template <typename Math, typename SampleType>
+    void processGroups(ChainState<SampleType>& chain, juce::dsp::AudioBlock<SampleType>& block, const BlockRamps& ramps);
+
+    // Dry capture, resampling, both sections and the compressor for one group, with
+    // the given saturation tier. Stage timings are only taken on the audio thread.
+    template <typename Math, typename SampleType>
+    void processStages(ChannelGroup<SampleType>& group, juce::dsp::AudioBlock<SampleType>& block,
+                       const BlockRamps& ramps, bool timeStages);
+
+    // Nonlinear stages, run oversampled, one stage over the whole block at a time.
+    // Kept as the reference the fused kernel is checked against.
+    template <typename Math, FlavorKernel Flavor, typename SampleType>
+    static void processChain(ChannelGroup<SampleType>& group, juce::dsp::AudioBlock<SampleType>& oversampledBlock,
+                             const BlockRamps& ramps);
+
+    // Same result in a single pass: every stage and the flavor sum run per sample,
+    // so nothing goes through the scratch buffers
+    template <typename Math, FlavorKernel Flavor, typename SampleType>
+    static void processChainFused(ChannelGroup<SampleType>& group, juce::dsp::AudioBlock<SampleType>& oversampledBlock,
+                                  const BlockRamps& ramps);
+
+    // Tone, dry/wet, output gain and final clip, run at the original rate
+    template <typename Math, MixKernel Mix, typename SampleType>
+    static void processOutputStage(ChannelGroup<SampleType>& group, juce::dsp::AudioBlock<SampleType>& block,
+                                   const BlockRamps& ramps);
 
     juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
     juce::String currentPresetName{ "Default" };
 
+    // One bank for the whole process; its scan results arrive as change messages
+    juce::SharedResourcePointer<PresetBank> presetBank;
+    void changeListenerCallback(juce::ChangeBroadcaster*) override;
+
+    // setCurrentProgram() can come from any thread; the message thread applies it
+    std::atomic<int> currentProgram{ 0 }, pendingProgram{ -1 };
+    void applyPendingProgram();
+
+    // What live mode forces, and what it found there to restore afterwards
+    static constexpr std::array<const char*, 7> liveModeIDs{
+        "oversampling", "osfilter", "quality", "lookahead", "driveadaa", "distadaa", "foldadaa"
+    };
+    static constexpr std::array<float, 7> liveModeValues{ 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 1.0f, 1.0f };
+    std::array<float, 7> valuesBeforeLiveMode{};
+    bool liveMode = false;
+
     //Oversampling
-    juce::dsp::Oversampling<float> oversampler{ 2, 2, juce::dsp::Oversampling<float>::filterHalfBandPolyphaseIIR };
+    static constexpr int maxOversamplingFactor = 8;
+    int preparedBlockSize = 0;
+
+    std::atomic<bool> oversamplerRebuildNeeded{ false };
+
+    // How often the message thread looks for rebuild requests and retired
+    // oversamplers. Polling means the audio thread only ever writes the atomics;
+    // it never posts a message, which may block.
+    static constexpr int housekeepingIntervalMs = 20;
+
+    // Fades bracketing an oversampler swap, so switching never clicks
+    bool fadedOutForSwap = false;
+
+    // Render quality: 8x oversampling, reference saturation, tighter coefficient updates.
+    // "Auto" uses it whenever the host renders offline.
+    bool useRenderQuality() const;
+    void requestOversamplerRebuild();
+
+    // Compressor delay the lookahead switch asks for. It changes the reported latency,
+    // so it is only applied at an oversampler swap, under the same fades.
+    int getLookaheadSamples() const;
+
+    template <typename SampleType>
+    std::unique_ptr<SharedOversampling<SampleType>> createOversampler() const;
+
+    // Builds replacements for the chain in use and queues them for the audio thread
+    template <typename SampleType>
+    void offerOversamplers(ChainState<SampleType>& chain);
+
+    // Message thread: frees retired oversamplers and builds requested ones
+    void timerCallback() override;
+
+    // Re-prepares everything that runs at the oversampled rate
+    template <typename SampleType>
+    void prepareOversampledStages(ChainState<SampleType>& chain);
+
+    template <typename SampleType>
+    static int getOversamplerLatency(const ChainState<SampleType>& chain);
+
+    // Worst case over every factor and filter, for sizing the dry delay
+    static int getMaximumOversamplerLatency();
+
+    // What the dry path is held back by: the oversampler's latency plus the
+    // fraction of a sample the ADAA stages add to the wet path
+    template <typename SampleType>
+    SampleType getDryDelay(const ChainState<SampleType>& chain) const;
 
-    // 2x oversampling (stereo)
+    template <typename SampleType>
+    size_t getChainHeapBytes(const ChainState<SampleType>& chain) const;
 
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DREKAVACAudioProcessor)
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <utility>
+#include <vector>
+
+//==============================================================================
+// Every .preset file in one folder, parsed once on a background thread and kept
+// as plain values, one row of parameter values per preset in a single flat
+// array. Switching presets then only copies a row; nothing touches the disk.
+//
+// One bank serves every instance in the process through
+// juce::SharedResourcePointer, so the folder is scanned by one thread, once,
+// however many instances a session opens. A finished scan is broadcast to all
+// of them as a change message.
+//
+// Entry 0 is always "Default", the layout's own defaults, so the bank is never
+// empty. All accessors are for the message thread.
+class PresetBank : private juce::Thread,
+                   public juce::ChangeBroadcaster
+{
+public:
+    PresetBank() : juce::Thread("DREKAVAC preset scan") {}
+
+    ~PresetBank() override
+    {
+        stopThread(2000);
+    }
+
+    // Every instance passes the same layout; the first one to arrive sets it
+    void setLayout(juce::Identifier stateType, juce::StringArray ids, juce::Array<float> defaults)
+    {
+        jassert(ids.size() == defaults.size());
+
+        if (!parameterIDs.isEmpty())
+        {
+            jassert(ids == parameterIDs);
+            return;
+        }
+
+        stateTag = std::move(stateType);
+        parameterIDs = std::move(ids);
+        defaultValues = std::move(defaults);
+
+        const juce::ScopedLock sl(lock);
+        names = { "Default" };
+        values.assign(defaultValues.begin(), defaultValues.end());
+    }
+
+    static juce::File getDefaultDirectory()
+    {
+        return juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+            .getChildFile("DISTEK").getChildFile("DREKAVAC").getChildFile("Presets");
+    }
+
+    const juce::File& getDirectory() const noexcept { return directory; }
+
+    // Starts a fresh scan; the current list stays in use until it finishes
+    void scan(const juce::File& folder)
+    {
+        jassert(!parameterIDs.isEmpty());
+
+        stopThread(2000);
+        directory = folder;
+        scanStarted = true;
+        startThread(juce::Thread::Priority::low);
+    }
+
+    // The first instance to ask starts the scan; the rest share its result
+    void scanOnce(const juce::File& folder)
+    {
+        if (!scanStarted)
+            scan(folder);
+    }
+
+    void rescan() { scan(directory); }
+
+    int getNumPresets() const
+    {
+        const juce::ScopedLock sl(lock);
+        return names.size();
+    }
+
+    juce::String getName(int index) const
+    {
+        const juce::ScopedLock sl(lock);
+        return names[index];
+    }
+
+    // Copies one preset's values, in parameter ID order, false for a bad index
+    bool getValues(int index, float* destination) const
+    {
+        const juce::ScopedLock sl(lock);
+        if (!juce::isPositiveAndBelow(index, names.size()))
+            return false;
+
+        std::copy_n(values.begin() + (std::ptrdiff_t)index * parameterIDs.size(), parameterIDs.size(), destination);
+        return true;
+    }
+
+private:
+    void run() override
+    {
+        juce::StringArray newNames{ "Default" };
+        std::vector<float> newValues(defaultValues.begin(), defaultValues.end());
+
+        auto files = directory.findChildFiles(juce::File::findFiles, false, "*.preset");
+        files.sort();
+
+        for (const auto& file : files)
+        {
+            if (threadShouldExit())
+                return;
+
+            auto xml = juce::XmlDocument::parse(file);
+            if (xml == nullptr || !xml->hasTagName(stateTag.toString()))
+                continue;
+
+            // Same lookup replaceState() does: a PARAM child per ID, or the default
+            for (int i = 0; i < parameterIDs.size(); ++i)
+            {
+                auto* param = xml->getChildByAttribute("id", parameterIDs[i]);
+                newValues.push_back(param != nullptr ? (float)param->getDoubleAttribute("value", defaultValues[i])
+                                                     : defaultValues[i]);
+            }
+
+            newNames.add(xml->getStringAttribute("presetName", file.getFileNameWithoutExtension()));
+        }
+
+        {
+            const juce::ScopedLock sl(lock);
+            names.swapWith(newNames);
+            values.swap(newValues);
+        }
+
+        // Listeners hear about it on the message thread
+        sendChangeMessage();
+    }
+
+    // Set once by setLayout(), before any scan reads them
+    juce::Identifier stateTag;
+    juce::StringArray parameterIDs;
+    juce::Array<float> defaultValues;
+
+    juce::File directory;
+    bool scanStarted = false;
+
+    juce::CriticalSection lock;
+    juce::StringArray names;
+    std::vector<float> values; // names.size() rows of parameterIDs.size() values
+
+    JUCE_DECLARE_NON_COPYABLE(PresetBank)
+};
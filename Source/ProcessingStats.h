@@ -0,0 +1,139 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include "SeqLock.h"
+
+//==============================================================================
+// What processBlock cost, as last published by the audio thread. Times are in
+// microseconds, loads are a proportion of the buffer period (1.0 = the whole
+// time the host gave us).
+struct ProcessingStats
+{
+    enum Stage
+    {
+        upsample,
+        chain,
+        downsample,
+        output,
+        numStages
+    };
+
+    double sampleRate = 0.0;
+    int blockSize = 0;
+    int latencySamples = 0;
+
+    // Last block
+    double blockMicroseconds = 0.0;
+    std::array<double, numStages> stageMicroseconds{};
+    double blockLoad = 0.0;
+
+    // Smoothed load and xruns from juce::AudioProcessLoadMeasurer
+    double averageLoad = 0.0;
+    int xrunCount = 0;
+
+    // Worst block over the current and the previous window
+    double peakBlockMicroseconds = 0.0;
+    double peakLoad = 0.0;
+
+    juce::uint64 blocksProcessed = 0;
+};
+
+//==============================================================================
+// Times processBlock and its stages, and hands the results to other threads
+// through a sequence lock, so the audio thread never waits on a reader.
+class ProcessingMeter
+{
+public:
+    // Peaks are held for this long, so a single spike stays readable on screen
+    static constexpr double peakWindowSeconds = 1.0;
+
+    void prepare(double sampleRate, int maximumBlockSize)
+    {
+        loadMeasurer.reset(sampleRate, maximumBlockSize);
+
+        current = {};
+        current.sampleRate = sampleRate;
+        windowLengthSamples = (juce::int64)(sampleRate * peakWindowSeconds);
+        windowSamples = 0;
+        windowPeakMicroseconds = previousPeakMicroseconds = 0.0;
+        windowPeakLoad = previousPeakLoad = 0.0;
+
+        publish();
+    }
+
+    //==============================================================================
+    // Audio thread
+
+    void beginBlock() noexcept
+    {
+        blockStartTicks = lastTicks = juce::Time::getHighResolutionTicks();
+        current.stageMicroseconds.fill(0.0);
+    }
+
+    // Charges the time since the previous mark to the given stage. A block that is
+    // processed in slices adds up each stage over all of them.
+    void endStage(ProcessingStats::Stage stage) noexcept
+    {
+        const auto now = juce::Time::getHighResolutionTicks();
+        current.stageMicroseconds[(size_t)stage] += ticksToMicroseconds(now - lastTicks);
+        lastTicks = now;
+    }
+
+    void endBlock(int numSamples, int latencySamples) noexcept
+    {
+        const auto blockMicroseconds = ticksToMicroseconds(juce::Time::getHighResolutionTicks() - blockStartTicks);
+        loadMeasurer.registerRenderTime(blockMicroseconds * 0.001, numSamples);
+
+        const auto periodMicroseconds = current.sampleRate > 0.0 ? 1.0e6 * numSamples / current.sampleRate : 0.0;
+
+        current.blockSize = numSamples;
+        current.latencySamples = latencySamples;
+        current.blockMicroseconds = blockMicroseconds;
+        current.blockLoad = periodMicroseconds > 0.0 ? blockMicroseconds / periodMicroseconds : 0.0;
+        current.averageLoad = loadMeasurer.getLoadAsProportion();
+        current.xrunCount = loadMeasurer.getXRunCount();
+        ++current.blocksProcessed;
+
+        windowPeakMicroseconds = juce::jmax(windowPeakMicroseconds, blockMicroseconds);
+        windowPeakLoad = juce::jmax(windowPeakLoad, current.blockLoad);
+
+        current.peakBlockMicroseconds = juce::jmax(windowPeakMicroseconds, previousPeakMicroseconds);
+        current.peakLoad = juce::jmax(windowPeakLoad, previousPeakLoad);
+
+        windowSamples += numSamples;
+        if (windowSamples >= windowLengthSamples)
+        {
+            previousPeakMicroseconds = windowPeakMicroseconds;
+            previousPeakLoad = windowPeakLoad;
+            windowPeakMicroseconds = windowPeakLoad = 0.0;
+            windowSamples = 0;
+        }
+
+        publish();
+    }
+
+    //==============================================================================
+    // Any thread
+
+    ProcessingStats getSnapshot() const noexcept { return published.read(); }
+
+private:
+    void publish() noexcept { published.write(current); }
+
+    static double ticksToMicroseconds(juce::int64 ticks) noexcept
+    {
+        return juce::Time::highResolutionTicksToSeconds(ticks) * 1.0e6;
+    }
+
+    juce::AudioProcessLoadMeasurer loadMeasurer;
+
+    // Audio thread only
+    ProcessingStats current;
+    juce::int64 blockStartTicks = 0, lastTicks = 0;
+    juce::int64 windowLengthSamples = 0, windowSamples = 0;
+    double windowPeakMicroseconds = 0.0, previousPeakMicroseconds = 0.0;
+    double windowPeakLoad = 0.0, previousPeakLoad = 0.0;
+
+    SeqLock<ProcessingStats> published;
+};
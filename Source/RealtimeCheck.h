@@ -0,0 +1,167 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+// Realtime-safety checks for test builds. With DREKAVAC_REALTIME_CHECKS=1 the
+// processor marks every thread while it runs audio code:
+//
+//   DREKAVAC_REALTIME_SCOPE("processBlock");
+//
+// and whatever the harness has hooked (allocations, locks, waits, sleeps, file
+// access, message posts) reports itself through RealtimeCheck::report() when it
+// happens on a marked thread. The hooks live with the harness, see
+// RealtimeHooks.cpp in DREKAVACBench; what they reach differs by platform, and
+// installHooks() records per kind how it is caught, or that it is not. Without
+// the define the macro compiles to nothing.
+//
+// A report either counts and carries on, so one run lists every kind of
+// problem, or traps straight away, which leaves the offending call on the stack
+// in a debugger. report() itself never allocates, locks or prints unless it is
+// about to trap.
+#ifndef DREKAVAC_REALTIME_CHECKS
+ #define DREKAVAC_REALTIME_CHECKS 0
+#endif
+
+#if DREKAVAC_REALTIME_CHECKS
+
+#include <array>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+
+namespace RealtimeCheck
+{
+    enum Violation
+    {
+        allocation,
+        deallocation,
+        lock,
+        wait,
+        sleep,
+        fileAccess,
+        messagePost,
+        numViolations
+    };
+
+    inline const char* getName(int violation) noexcept
+    {
+        static const char* names[] = { "allocation", "deallocation", "lock", "wait", "sleep or yield",
+                                       "file access", "message post" };
+        return juce::isPositiveAndBelow(violation, (int)numViolations) ? names[violation] : "unknown";
+    }
+
+    struct Record
+    {
+        Violation violation = allocation;
+        const char* scope = nullptr;
+    };
+
+    struct State
+    {
+        static constexpr int maxRecords = 32;
+
+        std::array<std::atomic<int>, numViolations> counts{};
+        std::array<Record, maxRecords> records{};
+        std::atomic<int> numRecords{ 0 };
+        std::atomic<bool> trap{ false };
+
+        // How each kind is caught on this platform, null where it is not
+        std::array<const char*, numViolations> coverage{};
+
+        static State& get() noexcept
+        {
+            static State state;
+            return state;
+        }
+    };
+
+    // Innermost marked scope on this thread, null outside audio code
+    inline thread_local const char* currentScope = nullptr;
+
+    // Set while a report is handled, so the hooks it might hit stay quiet
+    inline thread_local bool reporting = false;
+
+    inline bool isAudioThread() noexcept { return currentScope != nullptr && !reporting; }
+
+    // Called from the hooks, on whatever thread made the call
+    inline void report(Violation violation) noexcept
+    {
+        if (!isAudioThread())
+            return;
+
+        reporting = true;
+        auto& state = State::get();
+        state.counts[(size_t)violation].fetch_add(1, std::memory_order_relaxed);
+
+        const int index = state.numRecords.fetch_add(1, std::memory_order_relaxed);
+        if (index < State::maxRecords)
+            state.records[(size_t)index] = { violation, currentScope };
+
+        if (state.trap.load(std::memory_order_relaxed))
+        {
+            std::fprintf(stderr, "Realtime violation: %s in %s\n", getName(violation), currentScope);
+
+            if (juce::Process::isRunningUnderDebugger())
+                JUCE_BREAK_IN_DEBUGGER;
+            else
+                std::abort();
+        }
+
+        reporting = false;
+    }
+
+    inline void setTrapping(bool shouldTrap) noexcept { State::get().trap.store(shouldTrap); }
+
+    // Total reports since the last reset(), and how many of them were of one kind
+    inline int getNumViolations() noexcept { return State::get().numRecords.load(); }
+    inline int getNumViolations(Violation violation) noexcept { return State::get().counts[(size_t)violation].load(); }
+
+    // The first few reports, oldest first; call once the audio has stopped
+    inline int getRecords(Record* destination, int maxRecords) noexcept
+    {
+        auto& state = State::get();
+        const int numRecords = juce::jmin(maxRecords, state.numRecords.load(), State::maxRecords);
+        std::copy_n(state.records.begin(), numRecords, destination);
+        return numRecords;
+    }
+
+    inline void reset() noexcept
+    {
+        auto& state = State::get();
+        for (auto& count : state.counts)
+            count.store(0);
+        state.numRecords.store(0);
+    }
+
+    // Defined by the harness, in RealtimeHooks.cpp: installs whatever hooks the
+    // platform allows and records what they cover
+    void installHooks();
+
+    inline void setCoverage(Violation violation, const char* how) noexcept { State::get().coverage[(size_t)violation] = how; }
+    inline const char* getCoverage(Violation violation) noexcept { return State::get().coverage[(size_t)violation]; }
+
+    class ScopedAudioThread
+    {
+    public:
+        explicit ScopedAudioThread(const char* scopeName) noexcept : previous(currentScope)
+        {
+            currentScope = scopeName;
+        }
+
+        ~ScopedAudioThread() { currentScope = previous; }
+
+    private:
+        const char* const previous;
+
+        JUCE_DECLARE_NON_COPYABLE(ScopedAudioThread)
+    };
+}
+
+ #define DREKAVAC_REALTIME_SCOPE(name) const RealtimeCheck::ScopedAudioThread JUCE_JOIN_MACRO(drekavacRealtimeScope, __LINE__){ "" name }
+
+#else
+
+ #define DREKAVAC_REALTIME_SCOPE(name)
+
+#endif
@@ -0,0 +1,262 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+
+//==============================================================================
+// Fixed-width pack holding one sample per channel, so a group of channels moves
+// through the DSP chain in lockstep. Works like juce::dsp::SIMDRegister, but is
+// sized to the bus instead of the native register, and every operator is a
+// plain loop over the lanes that the compiler turns into vector instructions.
+template <typename SampleType, size_t NumLanes>
+struct SampleLanes
+{
+    using ValueType = SampleType;
+
+    std::array<SampleType, NumLanes> lanes{};
+
+    static constexpr size_t size() noexcept { return NumLanes; }
+
+    static SampleLanes expand(SampleType value) noexcept
+    {
+        SampleLanes result;
+        result.lanes.fill(value);
+        return result;
+    }
+
+    // Gathers one sample from each channel pointer
+    static SampleLanes load(const SampleType* const* channels, int index) noexcept
+    {
+        SampleLanes result;
+        for (size_t i = 0; i < NumLanes; ++i)
+            result.lanes[i] = channels[i][index];
+        return result;
+    }
+
+    // Scatters the lanes back out to the channel pointers
+    void store(SampleType* const* channels, int index) const noexcept
+    {
+        for (size_t i = 0; i < NumLanes; ++i)
+            channels[i][index] = lanes[i];
+    }
+
+    SampleType& operator[](size_t i) noexcept { return lanes[i]; }
+    const SampleType& operator[](size_t i) const noexcept { return lanes[i]; }
+
+    // Applies a scalar function to every lane
+    template <typename Fn>
+    SampleLanes map(Fn&& fn) const noexcept
+    {
+        SampleLanes result;
+        for (size_t i = 0; i < NumLanes; ++i)
+            result.lanes[i] = fn(lanes[i]);
+        return result;
+    }
+
+    SampleLanes& operator+=(const SampleLanes& other) noexcept { for (size_t i = 0; i < NumLanes; ++i) lanes[i] += other.lanes[i]; return *this; }
+    SampleLanes& operator-=(const SampleLanes& other) noexcept { for (size_t i = 0; i < NumLanes; ++i) lanes[i] -= other.lanes[i]; return *this; }
+    SampleLanes& operator*=(const SampleLanes& other) noexcept { for (size_t i = 0; i < NumLanes; ++i) lanes[i] *= other.lanes[i]; return *this; }
+    SampleLanes& operator/=(const SampleLanes& other) noexcept { for (size_t i = 0; i < NumLanes; ++i) lanes[i] /= other.lanes[i]; return *this; }
+
+    SampleLanes& operator+=(SampleType s) noexcept { for (auto& v : lanes) v += s; return *this; }
+    SampleLanes& operator-=(SampleType s) noexcept { for (auto& v : lanes) v -= s; return *this; }
+    SampleLanes& operator*=(SampleType s) noexcept { for (auto& v : lanes) v *= s; return *this; }
+    SampleLanes& operator/=(SampleType s) noexcept { for (auto& v : lanes) v /= s; return *this; }
+
+    SampleLanes operator-() const noexcept { return map([](SampleType v) { return -v; }); }
+
+    friend SampleLanes operator+(SampleLanes a, const SampleLanes& b) noexcept { return a += b; }
+    friend SampleLanes operator-(SampleLanes a, const SampleLanes& b) noexcept { return a -= b; }
+    friend SampleLanes operator*(SampleLanes a, const SampleLanes& b) noexcept { return a *= b; }
+    friend SampleLanes operator/(SampleLanes a, const SampleLanes& b) noexcept { return a /= b; }
+
+    friend SampleLanes operator+(SampleLanes a, SampleType s) noexcept { return a += s; }
+    friend SampleLanes operator-(SampleLanes a, SampleType s) noexcept { return a -= s; }
+    friend SampleLanes operator*(SampleLanes a, SampleType s) noexcept { return a *= s; }
+    friend SampleLanes operator/(SampleLanes a, SampleType s) noexcept { return a /= s; }
+
+    friend SampleLanes operator+(SampleType s, const SampleLanes& a) noexcept { return expand(s) += a; }
+    friend SampleLanes operator-(SampleType s, const SampleLanes& a) noexcept { return expand(s) -= a; }
+    friend SampleLanes operator*(SampleType s, const SampleLanes& a) noexcept { return expand(s) *= a; }
+    friend SampleLanes operator/(SampleType s, const SampleLanes& a) noexcept { return expand(s) /= a; }
+};
+
+// Left/right pair processed together
+template <typename SampleType>
+using StereoLanes = SampleLanes<SampleType, 2>;
+
+using StereoSample = StereoLanes<float>;
+
+// Runs fn over every frame of the block in place, one lane per channel. A block
+// with fewer channels than lanes repeats its last channel in the spare lanes.
+template <typename LaneType, typename Fn>
+void processLanes(juce::dsp::AudioBlock<typename LaneType::ValueType>& block, Fn&& fn) noexcept
+{
+    using ValueType = typename LaneType::ValueType;
+
+    ValueType* channels[LaneType::size()];
+    for (size_t lane = 0; lane < LaneType::size(); ++lane)
+        channels[lane] = block.getChannelPointer(juce::jmin(lane, block.getNumChannels() - 1));
+
+    const auto numSamples = (int)block.getNumSamples();
+    for (int i = 0; i < numSamples; ++i)
+        fn(LaneType::load(channels, i)).store(channels, i);
+}
+
+// Walks a block in consecutive sub-blocks of at most maxLength samples
+template <typename SampleType, typename Fn>
+void forEachSubBlock(juce::dsp::AudioBlock<SampleType>& block, size_t maxLength, Fn&& fn)
+{
+    const auto numSamples = block.getNumSamples();
+    for (size_t start = 0; start < numSamples; start += maxLength)
+    {
+        auto subBlock = block.getSubBlock(start, juce::jmin(maxLength, numSamples - start));
+        fn(subBlock);
+    }
+}
+
+//==============================================================================
+// Transposed direct form II biquad keeping one state pair per lane. Designs come
+// from juce::dsp::IIR::ArrayCoefficients, normalised the same way
+// juce::dsp::IIR::Coefficients does, so the response matches
+// juce::dsp::IIR::Filter while all lanes share one coefficient set.
+template <typename LaneType>
+class LaneBiquad
+{
+public:
+    using ValueType = typename LaneType::ValueType;
+
+    // b0, b1, b2, a1, a2 with a0 divided out
+    using NormalisedCoefficients = std::array<ValueType, 5>;
+
+    // Normalises an { b0, b1, b2, a0, a1, a2 } design as returned by
+    // juce::dsp::IIR::ArrayCoefficients, without touching the heap
+    static NormalisedCoefficients normalise(const std::array<ValueType, 6>& design) noexcept
+    {
+        const auto a0Inv = ValueType(1) / design[3];
+        return { design[0] * a0Inv, design[1] * a0Inv, design[2] * a0Inv, design[4] * a0Inv, design[5] * a0Inv };
+    }
+
+    void setCoefficients(const std::array<ValueType, 6>& design) noexcept
+    {
+        setCoefficients(normalise(design));
+    }
+
+    void setCoefficients(const NormalisedCoefficients& c) noexcept
+    {
+        b0 = c[0];
+        b1 = c[1];
+        b2 = c[2];
+        a1 = c[3];
+        a2 = c[4];
+    }
+
+    LaneType processSample(const LaneType& input) noexcept
+    {
+        auto output = input * b0 + s1;
+        s1 = input * b1 - output * a1 + s2;
+        s2 = input * b2 - output * a2;
+        return output;
+    }
+
+    void reset() noexcept
+    {
+        s1 = {};
+        s2 = {};
+    }
+
+private:
+    ValueType b0 = 1, b1 = 0, b2 = 0, a1 = 0, a2 = 0;
+    LaneType s1{}, s2{};
+};
+
+//==============================================================================
+// Trapezoidal (topology-preserving) state variable filter after Andrew Simper,
+// one integrator state pair per lane. The state is the integrators rather than
+// past outputs, so coefficients can change every sample, even abruptly, without
+// the clicks or instability of a direct form biquad. Static responses match
+// the RBJ designs in juce::dsp::IIR::ArrayCoefficients.
+template <typename LaneType>
+class LaneSVF
+{
+public:
+    using ValueType = typename LaneType::ValueType;
+
+    // a1..a3 run the integrators, m0..m2 mix input, band and low into the output
+    struct Coefficients
+    {
+        ValueType a1 = 1, a2 = 0, a3 = 0;
+        ValueType m0 = 0, m1 = 0, m2 = 1;
+    };
+
+    // Cutoff warped to the integrator gain, g = tan(pi * f / fs)
+    static ValueType warp(double sampleRate, double frequency) noexcept
+    {
+        return (ValueType)std::tan(juce::MathConstants<double>::pi * juce::jmin(frequency, sampleRate * 0.49) / sampleRate);
+    }
+
+    // k is 1 / Q
+    static Coefficients makeLowPass(ValueType g, ValueType k) noexcept
+    {
+        Coefficients c;
+        setIntegrators(c, g, k);
+        c.m0 = 0;
+        c.m1 = 0;
+        c.m2 = 1;
+        return c;
+    }
+
+    // gainFactor is linear, as for ArrayCoefficients::makeLowShelf
+    static Coefficients makeLowShelf(ValueType g, ValueType k, ValueType gainFactor) noexcept
+    {
+        const auto A = std::sqrt(gainFactor);
+
+        Coefficients c;
+        setIntegrators(c, g / std::sqrt(A), k);
+        c.m0 = 1;
+        c.m1 = k * (A - 1);
+        c.m2 = gainFactor - 1;
+        return c;
+    }
+
+    static Coefficients makeHighShelf(ValueType g, ValueType k, ValueType gainFactor) noexcept
+    {
+        const auto A = std::sqrt(gainFactor);
+
+        Coefficients c;
+        setIntegrators(c, g * std::sqrt(A), k);
+        c.m0 = gainFactor;
+        c.m1 = k * (1 - A) * A;
+        c.m2 = 1 - gainFactor;
+        return c;
+    }
+
+    void setCoefficients(const Coefficients& newCoefficients) noexcept { c = newCoefficients; }
+
+    LaneType processSample(const LaneType& input) noexcept
+    {
+        const auto v3 = input - ic2;
+        const auto v1 = ic1 * c.a1 + v3 * c.a2;
+        const auto v2 = ic2 + ic1 * c.a2 + v3 * c.a3;
+        ic1 = v1 * ValueType(2) - ic1;
+        ic2 = v2 * ValueType(2) - ic2;
+        return input * c.m0 + v1 * c.m1 + v2 * c.m2;
+    }
+
+    void reset() noexcept
+    {
+        ic1 = {};
+        ic2 = {};
+    }
+
+private:
+    static void setIntegrators(Coefficients& c, ValueType g, ValueType k) noexcept
+    {
+        c.a1 = ValueType(1) / (ValueType(1) + g * (g + k));
+        c.a2 = g * c.a1;
+        c.a3 = g * c.a2;
+    }
+
+    Coefficients c;
+    LaneType ic1{}, ic2{};
+};
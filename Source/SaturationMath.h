@@ -0,0 +1,253 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <cstring>
+#include "SampleLanes.h"
+
+//==============================================================================
+// Saturation math in two precision tiers. The DSP stages take one of these as a
+// template argument, so the choice is made once per block and every call below
+// inlines into the sample loop.
+//
+// RenderSaturation calls the standard library and is bit-identical to the
+// original chain. RealtimeSaturation uses branch-free rational/polynomial
+// approximations (about -80 dB error) that vectorise across lanes.
+// TableSaturation trades those for table lookups with linear interpolation.
+
+struct RenderSaturation
+{
+    template <typename FloatType>
+    static FloatType tanh(FloatType x) noexcept { return std::tanh(x); }
+
+    template <typename FloatType>
+    static FloatType sin(FloatType x) noexcept { return std::sin(x); }
+
+    template <typename FloatType, size_t NumLanes>
+    static SampleLanes<FloatType, NumLanes> tanh(const SampleLanes<FloatType, NumLanes>& x) noexcept
+    {
+        return x.map([](FloatType v) { return std::tanh(v); });
+    }
+
+    template <typename FloatType, size_t NumLanes>
+    static SampleLanes<FloatType, NumLanes> sin(const SampleLanes<FloatType, NumLanes>& x) noexcept
+    {
+        return x.map([](FloatType v) { return std::sin(v); });
+    }
+};
+
+struct RealtimeSaturation
+{
+    // 7/6 Pade approximant, clamped where it meets the asymptote
+    template <typename FloatType>
+    static FloatType tanh(FloatType x) noexcept
+    {
+        x = juce::jlimit(FloatType(-5), FloatType(5), x);
+        auto x2 = x * x;
+        auto numerator = x * (FloatType(135135) + x2 * (FloatType(17325) + x2 * (FloatType(378) + x2)));
+        auto denominator = FloatType(135135) + x2 * (FloatType(62370) + x2 * (FloatType(3150) + x2 * FloatType(28)));
+        return juce::jlimit(FloatType(-1), FloatType(1), numerator / denominator);
+    }
+
+    // Reduces to [-pi/2, pi/2], then an odd degree-9 polynomial
+    template <typename FloatType>
+    static FloatType sin(FloatType x) noexcept
+    {
+        const auto pi = juce::MathConstants<FloatType>::pi;
+        const auto invPi = FloatType(1) / pi;
+
+        auto k = std::floor(x * invPi + FloatType(0.5));
+        auto r = x - k * pi;
+
+        // (-1)^k without a branch
+        auto parity = k - FloatType(2) * std::floor(k * FloatType(0.5));
+        auto sign = FloatType(1) - FloatType(2) * parity;
+
+        auto r2 = r * r;
+        auto p = r * (FloatType(1) + r2 * (FloatType(-1.0 / 6.0) + r2 * (FloatType(1.0 / 120.0)
+                      + r2 * (FloatType(-1.0 / 5040.0) + r2 * FloatType(1.0 / 362880.0)))));
+        return sign * p;
+    }
+
+    template <typename FloatType, size_t NumLanes>
+    static SampleLanes<FloatType, NumLanes> tanh(const SampleLanes<FloatType, NumLanes>& x) noexcept
+    {
+        return x.map([](FloatType v) { return RealtimeSaturation::tanh(v); });
+    }
+
+    template <typename FloatType, size_t NumLanes>
+    static SampleLanes<FloatType, NumLanes> sin(const SampleLanes<FloatType, NumLanes>& x) noexcept
+    {
+        return x.map([](FloatType v) { return RealtimeSaturation::sin(v); });
+    }
+};
+
+// Interpolated lookup tables, for targets where even the rational forms are too
+// slow. The knob gains are applied before the lookup, so the tables only depend
+// on the input and are built once, off the audio thread, by prepare().
+struct TableSaturation
+{
+    static constexpr size_t tableSize = 2048;
+
+    // Builds the shared tables; call before the first block is processed
+    static void prepare() { (void)getTables(); }
+
+    // Both tables, held once per process (LookupTable keeps one guard point)
+    static constexpr size_t getTableBytes() noexcept { return 2 * (tableSize + 1) * sizeof(float); }
+
+    // Holds tanh(+/-5) past the table edge (1e-4 off), about 3e-6 error inside.
+    // The tables are float, so a double chain gets float accuracy from this tier.
+    template <typename FloatType>
+    static FloatType tanh(FloatType x) noexcept { return (FloatType)getTables().tanh.processSample((float)x); }
+
+    // Reduces to one period, then looks up
+    template <typename FloatType>
+    static FloatType sin(FloatType x) noexcept
+    {
+        const auto twoPi = juce::MathConstants<FloatType>::twoPi;
+        const auto r = x - twoPi * std::floor(x * (FloatType(1) / twoPi) + FloatType(0.5));
+        return (FloatType)getTables().sin.processSample((float)r);
+    }
+
+    template <typename FloatType, size_t NumLanes>
+    static SampleLanes<FloatType, NumLanes> tanh(const SampleLanes<FloatType, NumLanes>& x) noexcept
+    {
+        return x.map([](FloatType v) { return TableSaturation::tanh(v); });
+    }
+
+    template <typename FloatType, size_t NumLanes>
+    static SampleLanes<FloatType, NumLanes> sin(const SampleLanes<FloatType, NumLanes>& x) noexcept
+    {
+        return x.map([](FloatType v) { return TableSaturation::sin(v); });
+    }
+
+private:
+    struct Tables
+    {
+        Tables()
+        {
+            const auto pi = juce::MathConstants<float>::pi;
+            tanh.initialise([](float x) { return std::tanh(x); }, -5.0f, 5.0f, tableSize);
+            sin.initialise([](float x) { return std::sin(x); }, -pi, pi, tableSize);
+        }
+
+        juce::dsp::LookupTableTransform<float> tanh, sin;
+    };
+
+    static const Tables& getTables()
+    {
+        static const Tables tables;
+        return tables;
+    }
+};
+
+//==============================================================================
+// First-order antiderivative antialiasing. Instead of f(x[n]) the shaper outputs
+// the mean of f over the segment from x[n-1] to x[n],
+//
+//     (F(x[n]) - F(x[n-1])) / (x[n] - x[n-1]),
+//
+// which suppresses aliasing much like extra oversampling, at half a sample of
+// delay. The difference quotient amplifies any rounding in F, so F is evaluated
+// in double; when the step is too small it falls back to f at the midpoint.
+
+// tanh, antiderivative log(cosh(x)) written to stay finite for large |x|
+struct TanhShape
+{
+    template <typename Math, typename FloatType>
+    static FloatType apply(FloatType x) noexcept { return Math::tanh(x); }
+
+    static double antiderivative(double x) noexcept
+    {
+        const double ax = std::abs(x);
+        return ax + std::log1p(std::exp(-2.0 * ax)) - juce::MathConstants<double>::ln2;
+    }
+};
+
+// sin, antiderivative -cos(x)
+struct SineShape
+{
+    template <typename Math, typename FloatType>
+    static FloatType apply(FloatType x) noexcept { return Math::sin(x); }
+
+    static double antiderivative(double x) noexcept { return -std::cos(x); }
+};
+
+template <typename Shape, typename LaneType>
+class AntiderivativeShaper
+{
+public:
+    using Lanes = LaneType;
+    using ValueType = typename LaneType::ValueType;
+
+    template <typename Math>
+    Lanes process(const Lanes& x) noexcept
+    {
+        Lanes y;
+
+        for (size_t i = 0; i < Lanes::size(); ++i)
+        {
+            const double F = Shape::antiderivative((double)x[i]);
+            const double dx = (double)x[i] - (double)previousX[i];
+
+            if (!primed)
+                y[i] = Shape::template apply<Math>(x[i]);
+            else if (std::abs(dx) > minimumStep)
+                y[i] = (ValueType)((F - previousF[i]) / dx);
+            else
+                y[i] = Shape::template apply<Math>(ValueType(0.5) * (x[i] + previousX[i]));
+
+            previousX[i] = x[i];
+            previousF[i] = F;
+        }
+
+        primed = true;
+        return y;
+    }
+
+    // The next sample is shaped directly and seeds the state, so enabling
+    // mid-stream does not average against a stale input
+    void reset() noexcept { primed = false; }
+
+private:
+    static constexpr double minimumStep = 1.0e-5;
+
+    Lanes previousX;
+    SampleLanes<double, Lanes::size()> previousF;
+    bool primed = false;
+};
+
+//==============================================================================
+// Level-domain helpers for the compressor's gain computer. Both split the float
+// into exponent and mantissa and run a small minimax polynomial on the mantissa:
+// log2 is good to about 1e-4 (half a thousandth of a dB), exp2 to 5e-6 relative.
+
+// Expects a positive, normal input
+inline float fastLog2(float x) noexcept
+{
+    uint32_t bits;
+    std::memcpy(&bits, &x, sizeof(bits));
+
+    const float exponent = (float)((int)((bits >> 23) & 0xffu) - 127);
+    bits = (bits & 0x007fffffu) | 0x3f800000u;
+
+    float mantissa;
+    std::memcpy(&mantissa, &bits, sizeof(mantissa));
+
+    const float t = mantissa - 1.0f; // 0..1
+    return exponent + (8.7482178e-5f + t * (1.4377054f + t * (-0.67494597f + t * (0.31868314f + t * -0.081617637f))));
+}
+
+inline float fastExp2(float x) noexcept
+{
+    x = juce::jlimit(-126.0f, 126.0f, x);
+
+    const float whole = std::floor(x);
+    const float f = x - whole; // 0..1
+    const float p = 1.0000037f + f * (0.69296612f + f * (0.24163845f + f * (0.051690338f + f * 0.013697679f)));
+
+    const uint32_t bits = (uint32_t)((int)whole + 127) << 23;
+    float scale;
+    std::memcpy(&scale, &bits, sizeof(scale));
+
+    return p * scale;
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <type_traits>
+
+//==============================================================================
+// Single-writer sequence lock around a plain value. The writer never waits: it
+// only bumps the sequence around a copy. read() retries until it sees a copy
+// that no write overlapped, so it always gets one whole value, but a writer
+// preempted mid-write keeps it spinning; realtime readers use tryRead().
+template <typename Type>
+class SeqLock
+{
+public:
+    static_assert(std::is_trivially_copyable_v<Type>, "SeqLock copies its value byte for byte");
+
+    void write(const Type& newValue) noexcept
+    {
+        const auto s = sequence.load(std::memory_order_relaxed);
+        sequence.store(s + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        value = newValue;
+
+        sequence.store(s + 2, std::memory_order_release);
+    }
+
+    // Copies the latest value and returns the sequence it was written under,
+    // so a reader can tell a new value from one it has already seen
+    juce::uint32 read(Type& destination) const noexcept
+    {
+        for (;;)
+        {
+            const auto before = sequence.load(std::memory_order_acquire);
+            if ((before & 1u) == 0)
+            {
+                destination = value;
+                std::atomic_thread_fence(std::memory_order_acquire);
+
+                if (sequence.load(std::memory_order_relaxed) == before)
+                    return before;
+            }
+        }
+    }
+
+    Type read() const noexcept
+    {
+        Type copy;
+        read(copy);
+        return copy;
+    }
+
+    // Gives up after maxAttempts copies that a write overlapped, leaving
+    // destination as it was, so the caller can carry on with what it already has
+    bool tryRead(Type& destination, juce::uint32& readSequence, int maxAttempts = 16) const noexcept
+    {
+        for (int attempt = 0; attempt < maxAttempts; ++attempt)
+        {
+            const auto before = sequence.load(std::memory_order_acquire);
+            if ((before & 1u) != 0)
+                continue;
+
+            const Type copy = value;
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            if (sequence.load(std::memory_order_relaxed) == before)
+            {
+                destination = copy;
+                readSequence = before;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+private:
+    // Odd while a write is in progress
+    std::atomic<juce::uint32> sequence{ 0 };
+    Type value{};
+};
@@ -0,0 +1,478 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <juce_dsp/juce_dsp.h>
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <memory>
+#include <vector>
+#include "SharedTables.h"
+
+//==============================================================================
+// Cascade of 2x half-band stages, the same filters and structure as
+// juce::dsp::Oversampling at maximum quality with integer latency, except that
+// the filter designs come from SharedTables. A stage's design depends only on
+// its position in the cascade and the filter type, not on the sample rate, so
+// every instance and every factor that runs it shares one copy. Only the
+// buffers and filter state are per instance.
+//
+// Construction looks designs up and may build them, so it belongs on the
+// message thread like the rest of SharedTables.
+template <typename SampleType>
+class SharedOversampling
+{
+public:
+    enum FilterType
+    {
+        filterHalfBandPolyphaseIIR,
+        filterHalfBandFIREquiripple
+    };
+
+    // One direction of one stage: FIR taps, or the allpass coefficients of the
+    // direct path followed by those of the delayed path
+    struct HalfBand
+    {
+        std::vector<SampleType> coefficients;
+        size_t numDirect = 0;
+    };
+
+    struct StageDesign
+    {
+        HalfBand up, down;
+        SampleType latency = 0; // in samples at the stage's output rate
+
+        size_t getHeapBytes() const noexcept
+        {
+            return (up.coefficients.capacity() + down.coefficients.capacity()) * sizeof(SampleType);
+        }
+    };
+
+    // factorIndex 0..3 gives 1x, 2x, 4x, 8x
+    SharedOversampling(size_t channels, size_t factorIndex, FilterType type)
+        : numChannels(channels), filterType(type)
+    {
+        jassert(factorIndex <= 3 && numChannels > 0);
+
+        for (size_t n = 0; n < factorIndex; ++n)
+        {
+            auto stage = std::make_unique<Stage>();
+            stage->design = SharedTables::get<StageDesign>(0.0, 2 << n, (int)filterType,
+                                                            [this, n] { return design(n); });
+            stages.push_back(std::move(stage));
+        }
+
+        updateFractionalDelay();
+    }
+
+    SharedOversampling(const SharedOversampling&) = delete;
+    SharedOversampling& operator=(const SharedOversampling&) = delete;
+
+    size_t getOversamplingFactor() const noexcept { return (size_t)1 << stages.size(); }
+
+    SampleType getLatencyInSamples() const noexcept { return getUncompensatedLatency() + fractionalDelay; }
+
+    void initProcessing(size_t maximumNumberOfSamplesBeforeOversampling)
+    {
+        auto numSamples = maximumNumberOfSamplesBeforeOversampling;
+        bypassBuffer.setSize((int)numChannels, (int)numSamples, false, false, true);
+
+        for (auto& stage : stages)
+        {
+            numSamples *= 2;
+            const auto& design = *stage->design;
+
+            stage->buffer.setSize((int)numChannels, (int)numSamples, false, false, true);
+
+            if (filterType == filterHalfBandFIREquiripple)
+            {
+                const auto sizeUp = (int)design.up.coefficients.size();
+                const auto sizeDown = (int)design.down.coefficients.size();
+
+                stage->stateUp.setSize((int)numChannels, sizeUp);
+                stage->stateDown.setSize((int)numChannels, sizeDown);
+                stage->stateDown2.setSize((int)numChannels, sizeDown / 4 + 1);
+            }
+            else
+            {
+                stage->stateUp.setSize((int)numChannels, (int)design.up.coefficients.size());
+                stage->stateDown.setSize((int)numChannels, (int)design.down.coefficients.size());
+            }
+
+            stage->positions.assign(numChannels, 0);
+            stage->delayDown.assign(numChannels, 0);
+        }
+
+        delay.prepare({ 0.0, (juce::uint32)maximumNumberOfSamplesBeforeOversampling, (juce::uint32)numChannels });
+        delay.setDelay(fractionalDelay);
+        reset();
+    }
+
+    void reset() noexcept
+    {
+        for (auto& stage : stages)
+        {
+            stage->buffer.clear();
+            stage->stateUp.clear();
+            stage->stateDown.clear();
+            stage->stateDown2.clear();
+            std::fill(stage->positions.begin(), stage->positions.end(), (size_t)0);
+            std::fill(stage->delayDown.begin(), stage->delayDown.end(), (SampleType)0);
+        }
+
+        delay.reset();
+    }
+
+    juce::dsp::AudioBlock<SampleType> processSamplesUp(const juce::dsp::AudioBlock<const SampleType>& inputBlock) noexcept
+    {
+        const auto numSamples = inputBlock.getNumSamples();
+
+        // 1x still hands back a copy, so callers can treat every factor alike
+        if (stages.empty())
+        {
+            juce::dsp::AudioBlock<SampleType> copy(bypassBuffer);
+            copy = copy.getSubBlock(0, numSamples);
+            copy.copyFrom(inputBlock);
+            return copy;
+        }
+
+        auto block = juce::dsp::AudioBlock<const SampleType>(inputBlock);
+        juce::dsp::AudioBlock<SampleType> output;
+
+        for (auto& stage : stages)
+        {
+            if (filterType == filterHalfBandFIREquiripple)
+                upFIR(*stage, block);
+            else
+                upIIR(*stage, block);
+
+            output = juce::dsp::AudioBlock<SampleType>(stage->buffer).getSubBlock(0, block.getNumSamples() * 2);
+            block = juce::dsp::AudioBlock<const SampleType>(output);
+        }
+
+        return output;
+    }
+
+    void processSamplesDown(juce::dsp::AudioBlock<SampleType>& outputBlock) noexcept
+    {
+        if (stages.empty())
+        {
+            outputBlock.copyFrom(juce::dsp::AudioBlock<SampleType>(bypassBuffer).getSubBlock(0, outputBlock.getNumSamples()));
+            return;
+        }
+
+        // Each stage reads its own buffer and writes the one below it
+        for (size_t n = stages.size(); n-- > 0;)
+        {
+            const auto numSamplesOut = outputBlock.getNumSamples() << n;
+            auto destination = n == 0 ? outputBlock
+                                      : juce::dsp::AudioBlock<SampleType>(stages[n - 1]->buffer).getSubBlock(0, numSamplesOut);
+
+            if (filterType == filterHalfBandFIREquiripple)
+                downFIR(*stages[n], destination);
+            else
+                downIIR(*stages[n], destination);
+        }
+
+        if (fractionalDelay > 0)
+        {
+            juce::dsp::ProcessContextReplacing<SampleType> context(outputBlock);
+            delay.process(context);
+        }
+    }
+
+    // Buffers and filter state this instance holds; the designs are shared
+    size_t getHeapBytes() const noexcept
+    {
+        auto bufferBytes = [](const juce::AudioBuffer<SampleType>& buffer)
+            { return (size_t)buffer.getNumChannels() * (size_t)buffer.getNumSamples() * sizeof(SampleType); };
+
+        size_t bytes = bufferBytes(bypassBuffer)
+                     + numChannels * (size_t)(maximumDelay + 2) * sizeof(SampleType);
+
+        for (const auto& stage : stages)
+            bytes += sizeof(Stage) + bufferBytes(stage->buffer)
+                   + bufferBytes(stage->stateUp) + bufferBytes(stage->stateDown) + bufferBytes(stage->stateDown2)
+                   + numChannels * (sizeof(size_t) + sizeof(SampleType));
+
+        return bytes;
+    }
+
+private:
+    struct Stage
+    {
+        std::shared_ptr<const StageDesign> design;
+
+        // Output at this stage's rate, the input to the stage above
+        juce::AudioBuffer<SampleType> buffer;
+
+        // FIR: delay lines, with the centre tap's odd samples in stateDown2.
+        // IIR: one allpass state per section.
+        juce::AudioBuffer<SampleType> stateUp, stateDown, stateDown2;
+        std::vector<size_t> positions;
+        std::vector<SampleType> delayDown;
+    };
+
+    //==============================================================================
+    // The transition widths and stopbands juce::dsp::Oversampling uses at maximum
+    // quality: the first stage is the steep one, later stages can be wider
+    StageDesign design(size_t stageIndex) const
+    {
+        const auto n = (SampleType)stageIndex;
+        const auto widthUp = (SampleType)0.10 * (stageIndex == 0 ? (SampleType)0.5 : (SampleType)1);
+        const auto widthDown = (SampleType)0.12 * (stageIndex == 0 ? (SampleType)0.5 : (SampleType)1);
+        const auto stopbandUp = (SampleType)-90 + (SampleType)10 * n;
+        const auto stopbandDown = (SampleType)-75 + (SampleType)10 * n;
+
+        StageDesign result;
+
+        if (filterType == filterHalfBandFIREquiripple)
+        {
+            result.up = designFIR(widthUp, stopbandUp);
+            result.down = designFIR(widthDown, stopbandDown);
+
+            // Linear phase: half the order, for each direction
+            result.latency = (SampleType)(result.up.coefficients.size() + result.down.coefficients.size() - 2) / 2;
+        }
+        else
+        {
+            result.latency = designIIR(result.up, widthUp, stopbandUp) + designIIR(result.down, widthDown, stopbandDown);
+        }
+
+        return result;
+    }
+
+    static HalfBand designFIR(SampleType width, SampleType stopband)
+    {
+        auto fir = juce::dsp::FilterDesign<SampleType>::designFIRLowpassHalfBandEquirippleMethod(width, stopband);
+
+        HalfBand halfBand;
+        halfBand.coefficients.assign(fir->coefficients.begin(), fir->coefficients.end());
+        return halfBand;
+    }
+
+    // Fills in the allpass coefficients and returns the filter's group delay at DC
+    // in samples at the stage's output rate
+    static SampleType designIIR(HalfBand& halfBand, SampleType width, SampleType stopband)
+    {
+        auto structure = juce::dsp::FilterDesign<SampleType>::designIIRLowpassHalfBandPolyphaseAllpassMethod(width, stopband);
+
+        // The delayed path starts with the bare z^-1 that interleaving provides
+        for (auto* section : structure.directPath)
+            halfBand.coefficients.push_back(section->coefficients[0]);
+
+        halfBand.numDirect = halfBand.coefficients.size();
+
+        for (int i = 1; i < structure.delayedPath.size(); ++i)
+            halfBand.coefficients.push_back(structure.delayedPath.getObjectPointer(i)->coefficients[0]);
+
+        // Response of direct plus delayed path near DC, the way JUCE measures it
+        const double omega = 0.0001 * juce::MathConstants<double>::twoPi;
+        const auto zInverse = std::polar(1.0, -omega);
+
+        auto pathResponse = [&zInverse](const auto& path)
+            {
+                std::complex<double> response(1.0);
+
+                for (auto* section : path)
+                {
+                    const auto order = (int)section->getFilterOrder();
+                    const auto* c = section->getRawCoefficients();
+
+                    std::complex<double> numerator(0.0), denominator(1.0), power(1.0);
+                    for (int k = 0; k <= order; ++k)
+                    {
+                        numerator += (double)c[k] * power;
+                        if (k > 0)
+                            denominator += (double)c[order + k] * power;
+
+                        power *= zInverse;
+                    }
+
+                    response *= numerator / denominator;
+                }
+
+                return response;
+            };
+
+        const auto response = pathResponse(structure.directPath) + pathResponse(structure.delayedPath);
+        return (SampleType)(-std::arg(response) / omega);
+    }
+
+    //==============================================================================
+    void upFIR(Stage& stage, const juce::dsp::AudioBlock<const SampleType>& input) noexcept
+    {
+        const auto* fir = stage.design->up.coefficients.data();
+        const auto N = stage.design->up.coefficients.size();
+        const auto Ndiv2 = N / 2;
+        const auto numSamples = input.getNumSamples();
+
+        for (size_t channel = 0; channel < input.getNumChannels(); ++channel)
+        {
+            auto* output = stage.buffer.getWritePointer((int)channel);
+            auto* buf = stage.stateUp.getWritePointer((int)channel);
+            const auto* samples = input.getChannelPointer(channel);
+
+            for (size_t i = 0; i < numSamples; ++i)
+            {
+                // Zero stuffed, so only every other tap sees a sample
+                buf[N - 1] = 2 * samples[i];
+
+                SampleType out = 0;
+                for (size_t k = 0; k < Ndiv2; k += 2)
+                    out += (buf[k] + buf[N - k - 1]) * fir[k];
+
+                output[i << 1] = out;
+                output[(i << 1) + 1] = buf[Ndiv2 + 1] * fir[Ndiv2];
+
+                for (size_t k = 0; k < N - 2; k += 2)
+                    buf[k] = buf[k + 2];
+            }
+        }
+    }
+
+    void downFIR(Stage& stage, juce::dsp::AudioBlock<SampleType>& destination) noexcept
+    {
+        const auto* fir = stage.design->down.coefficients.data();
+        const auto N = stage.design->down.coefficients.size();
+        const auto Ndiv2 = N / 2;
+        const auto Ndiv4 = Ndiv2 / 2;
+        const auto numSamples = destination.getNumSamples();
+
+        for (size_t channel = 0; channel < destination.getNumChannels(); ++channel)
+        {
+            const auto* input = stage.buffer.getReadPointer((int)channel);
+            auto* buf = stage.stateDown.getWritePointer((int)channel);
+            auto* buf2 = stage.stateDown2.getWritePointer((int)channel);
+            auto* samples = destination.getChannelPointer(channel);
+            auto pos = stage.positions[channel];
+
+            for (size_t i = 0; i < numSamples; ++i)
+            {
+                buf[N - 1] = input[i << 1];
+
+                SampleType out = 0;
+                for (size_t k = 0; k < Ndiv2; k += 2)
+                    out += (buf[k] + buf[N - k - 1]) * fir[k];
+
+                // The odd samples only ever meet the centre tap
+                out += buf2[pos] * fir[Ndiv2];
+                buf2[pos] = input[(i << 1) + 1];
+
+                samples[i] = out;
+
+                for (size_t k = 0; k < N - 2; ++k)
+                    buf[k] = buf[k + 2];
+
+                pos = pos == 0 ? Ndiv4 : pos - 1;
+            }
+
+            stage.positions[channel] = pos;
+        }
+    }
+
+    void upIIR(Stage& stage, const juce::dsp::AudioBlock<const SampleType>& input) noexcept
+    {
+        const auto* coeffs = stage.design->up.coefficients.data();
+        const auto numStages = stage.design->up.coefficients.size();
+        const auto numDirect = stage.design->up.numDirect;
+        const auto numSamples = input.getNumSamples();
+
+        for (size_t channel = 0; channel < input.getNumChannels(); ++channel)
+        {
+            auto* output = stage.buffer.getWritePointer((int)channel);
+            auto* v1 = stage.stateUp.getWritePointer((int)channel);
+            const auto* samples = input.getChannelPointer(channel);
+
+            for (size_t i = 0; i < numSamples; ++i)
+            {
+                output[i << 1] = allpassCascade(coeffs, v1, 0, numDirect, samples[i]);
+                output[(i << 1) + 1] = allpassCascade(coeffs, v1, numDirect, numStages, samples[i]);
+            }
+
+            for (size_t n = 0; n < numStages; ++n)
+                juce::dsp::util::snapToZero(v1[n]);
+        }
+    }
+
+    void downIIR(Stage& stage, juce::dsp::AudioBlock<SampleType>& destination) noexcept
+    {
+        const auto* coeffs = stage.design->down.coefficients.data();
+        const auto numStages = stage.design->down.coefficients.size();
+        const auto numDirect = stage.design->down.numDirect;
+        const auto numSamples = destination.getNumSamples();
+
+        for (size_t channel = 0; channel < destination.getNumChannels(); ++channel)
+        {
+            const auto* input = stage.buffer.getReadPointer((int)channel);
+            auto* v1 = stage.stateDown.getWritePointer((int)channel);
+            auto* samples = destination.getChannelPointer(channel);
+            auto delayed = stage.delayDown[channel];
+
+            for (size_t i = 0; i < numSamples; ++i)
+            {
+                const auto direct = allpassCascade(coeffs, v1, 0, numDirect, input[i << 1]);
+
+                samples[i] = (delayed + direct) * (SampleType)0.5;
+                delayed = allpassCascade(coeffs, v1, numDirect, numStages, input[(i << 1) + 1]);
+            }
+
+            stage.delayDown[channel] = delayed;
+
+            for (size_t n = 0; n < numStages; ++n)
+                juce::dsp::util::snapToZero(v1[n]);
+        }
+    }
+
+    // First-order allpass sections [begin, end) in z^-2, run at the lower rate
+    static SampleType allpassCascade(const SampleType* coeffs, SampleType* v1,
+                                     size_t begin, size_t end, SampleType input) noexcept
+    {
+        for (auto n = begin; n < end; ++n)
+        {
+            const auto output = coeffs[n] * input + v1[n];
+            v1[n] = input - coeffs[n] * output;
+            input = output;
+        }
+
+        return input;
+    }
+
+    //==============================================================================
+    SampleType getUncompensatedLatency() const noexcept
+    {
+        SampleType latency = 0;
+        size_t order = 1;
+
+        for (const auto& stage : stages)
+        {
+            order *= 2;
+            latency += stage->design->latency / (SampleType)order;
+        }
+
+        return latency;
+    }
+
+    // Tops the latency up to a whole number of samples, keeping the Thiran
+    // delay above 0.618 where it stays well behaved, as JUCE does
+    void updateFractionalDelay() noexcept
+    {
+        const auto latency = getUncompensatedLatency();
+        fractionalDelay = (SampleType)1 - (latency - std::floor(latency));
+
+        if (fractionalDelay == (SampleType)1)
+            fractionalDelay = 0;
+        else if (fractionalDelay < (SampleType)0.618)
+            fractionalDelay += 1;
+    }
+
+    const size_t numChannels;
+    const FilterType filterType;
+
+    std::vector<std::unique_ptr<Stage>> stages;
+    juce::AudioBuffer<SampleType> bypassBuffer;
+
+    static constexpr int maximumDelay = 8;
+    juce::dsp::DelayLine<SampleType, juce::dsp::DelayLineInterpolationTypes::Thiran> delay{ maximumDelay };
+    SampleType fractionalDelay = 0;
+};
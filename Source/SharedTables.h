@@ -0,0 +1,101 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <map>
+#include <memory>
+#include <tuple>
+#include <utility>
+
+//==============================================================================
+// Process-wide cache of immutable DSP tables, keyed by sample rate, oversampling
+// factor and a variant such as the filter type. Every instance asking for the
+// same key gets the same table, built once, and a table lives for as long as
+// some instance keeps a reference to it. Distortion's cutoff curve and the
+// oversamplers' half-band designs (see SharedOversampling.h) go through here.
+//
+// Lookups lock and may build, so they belong on the message thread; the audio
+// thread only ever reads through a pointer taken here beforehand.
+struct SharedTables
+{
+    using Key = std::tuple<double, int, int>; // sample rate, oversampling factor, variant
+
+    struct Usage
+    {
+        int numTables = 0;    // alive anywhere in the process
+        size_t numBytes = 0;
+        int numBuilds = 0;    // since the process started
+    };
+
+    template <typename Table, typename Build>
+    static std::shared_ptr<const Table> get(double sampleRate, int factor, Build&& build)
+    {
+        return get<Table>(sampleRate, factor, 0, std::forward<Build>(build));
+    }
+
+    template <typename Table, typename Build>
+    static std::shared_ptr<const Table> get(double sampleRate, int factor, int variant, Build&& build)
+    {
+        auto& cache = getCache<Table>();
+        const juce::ScopedLock sl(cache.lock);
+
+        auto& entry = cache.entries[{ sampleRate, factor, variant }];
+        if (auto table = entry.lock())
+            return table;
+
+        std::shared_ptr<const Table> table = std::make_shared<const Table>(build());
+        entry = table;
+        ++cache.numBuilds;
+        return table;
+    }
+
+    template <typename Table>
+    static Usage getUsage()
+    {
+        auto& cache = getCache<Table>();
+        const juce::ScopedLock sl(cache.lock);
+
+        Usage usage;
+        for (auto it = cache.entries.begin(); it != cache.entries.end();)
+        {
+            auto table = it->second.lock();
+            if (table == nullptr)
+            {
+                it = cache.entries.erase(it);
+                continue;
+            }
+
+            ++usage.numTables;
+            usage.numBytes += sizeof(Table) + getHeapBytes(*table, 0);
+            ++it;
+        }
+
+        usage.numBuilds = cache.numBuilds;
+        return usage;
+    }
+
+private:
+    // Tables that own storage say how much through getHeapBytes()
+    template <typename Table>
+    static auto getHeapBytes(const Table& table, int) -> decltype((size_t)table.getHeapBytes())
+    {
+        return table.getHeapBytes();
+    }
+
+    template <typename Table>
+    static size_t getHeapBytes(const Table&, long) { return 0; }
+
+    template <typename Table>
+    struct Cache
+    {
+        juce::CriticalSection lock;
+        std::map<Key, std::weak_ptr<const Table>> entries;
+        int numBuilds = 0;
+    };
+
+    template <typename Table>
+    static Cache<Table>& getCache()
+    {
+        static Cache<Table> cache;
+        return cache;
+    }
+};
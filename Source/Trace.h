@@ -0,0 +1,225 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+// Timeline markers for chasing spikes in an external profiler. The macros
+// compile to nothing unless DREKAVAC_ENABLE_TRACING=1:
+//
+//   DREKAVAC_TRACE_SCOPE("name");        // one complete event for the enclosing scope
+//   DREKAVAC_TRACE_INSTANT("name");      // a single point in time
+//   DREKAVAC_TRACE_THREAD_NAME(string);  // labels the calling thread's track
+//
+// Names must be string literals; only the pointer is stored. Each thread that
+// records claims one fixed ring of events the first time it traces, and from
+// then on only writes into it, so recording never locks or allocates. Once a
+// ring is full the oldest events are overwritten.
+//
+// A thread finds its ring by its ID in a fixed table, not through thread_local.
+// In a plugin that the host loads with dlopen, thread_local is dynamic TLS,
+// and a thread's first touch of it may allocate, which for the host's audio
+// thread would happen right here. A thread that reuses the ID of one that has
+// exited carries on in its ring.
+//
+// Trace::exportJson() writes everything still held as Chrome trace JSON, which
+// chrome://tracing and ui.perfetto.dev both open. Timestamps are the raw
+// high-resolution clock in microseconds, the same clock the OS profilers use,
+// so the file lines up with a host or system trace taken at the same time.
+#ifndef DREKAVAC_ENABLE_TRACING
+ #define DREKAVAC_ENABLE_TRACING 0
+#endif
+
+#if DREKAVAC_ENABLE_TRACING
+
+#include <array>
+#include <atomic>
+#include <vector>
+
+namespace Trace
+{
+    struct Event
+    {
+        const char* name = nullptr;
+        juce::int64 start = 0;
+        juce::int64 end = 0; // equal to start for instants
+    };
+
+    class ThreadRing
+    {
+    public:
+        static constexpr int capacity = 1 << 14; // events, a power of two
+
+        // Owning thread only
+        void record(const char* name, juce::int64 start, juce::int64 end) noexcept
+        {
+            const auto index = written.load(std::memory_order_relaxed);
+            events[(size_t)(index & (capacity - 1))] = { name, start, end };
+            written.store(index + 1, std::memory_order_release);
+        }
+
+        // Any thread. Events the owner overwrote while they were being copied are
+        // dropped, along with the slot it may be writing right now.
+        void copyTo(std::vector<Event>& destination) const
+        {
+            const auto end = written.load(std::memory_order_acquire);
+            const auto begin = juce::jmax((juce::int64)0, end - capacity);
+
+            const auto first = destination.size();
+            for (auto i = begin; i < end; ++i)
+                destination.push_back(events[(size_t)(i & (capacity - 1))]);
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            const auto unsafe = written.load(std::memory_order_relaxed) - capacity - begin + 1;
+            if (unsafe > 0)
+                destination.erase(destination.begin() + (std::ptrdiff_t)first,
+                                  destination.begin() + (std::ptrdiff_t)(first + (size_t)juce::jmin(unsafe, end - begin)));
+        }
+
+        char threadName[64] = {}; // empty until the thread names itself
+        std::atomic<juce::uint64> threadID{ 0 };
+
+    private:
+        std::array<Event, capacity> events{};
+        std::atomic<juce::int64> written{ 0 };
+    };
+
+    struct Registry
+    {
+        static constexpr int maxThreads = 32;
+
+        std::array<ThreadRing, maxThreads> rings;
+        std::atomic<int> numClaimed{ 0 };
+
+        static Registry& get()
+        {
+            static Registry registry;
+            return registry;
+        }
+    };
+
+    // The calling thread's ring, claimed on first use; null once every ring is taken
+    inline ThreadRing* getThreadRing() noexcept
+    {
+        auto& registry = Registry::get();
+        const auto id = (juce::uint64)(juce::pointer_sized_uint)juce::Thread::getCurrentThreadId();
+
+        const int numClaimed = juce::jmin(registry.numClaimed.load(std::memory_order_acquire), Registry::maxThreads);
+        for (int i = 0; i < numClaimed; ++i)
+            if (registry.rings[(size_t)i].threadID.load(std::memory_order_acquire) == id)
+                return &registry.rings[(size_t)i];
+
+        if (numClaimed >= Registry::maxThreads)
+            return nullptr;
+
+        const int index = registry.numClaimed.fetch_add(1);
+        if (index >= Registry::maxThreads)
+            return nullptr;
+
+        auto& claimed = registry.rings[(size_t)index];
+        claimed.threadID.store(id, std::memory_order_release);
+        return &claimed;
+    }
+
+    // Not juce::Thread::getCurrentThread(), which has the same first-touch cost
+    // on threads JUCE did not start, so threads that want a name give it here
+    inline void nameThread(const juce::String& name) noexcept
+    {
+        if (auto* ring = getThreadRing())
+            name.copyToUTF8(ring->threadName, sizeof(ring->threadName));
+    }
+
+    inline void instant(const char* name) noexcept
+    {
+        if (auto* ring = getThreadRing())
+        {
+            const auto now = juce::Time::getHighResolutionTicks();
+            ring->record(name, now, now);
+        }
+    }
+
+    class Scope
+    {
+    public:
+        explicit Scope(const char* eventName) noexcept
+            : ring(getThreadRing()), name(eventName), start(juce::Time::getHighResolutionTicks())
+        {
+        }
+
+        ~Scope()
+        {
+            if (ring != nullptr)
+                ring->record(name, start, juce::Time::getHighResolutionTicks());
+        }
+
+    private:
+        ThreadRing* const ring;
+        const char* const name;
+        const juce::int64 start;
+
+        JUCE_DECLARE_NON_COPYABLE(Scope)
+    };
+
+    // Message thread or a worker, never the audio thread: builds the whole file in memory
+    inline bool exportJson(const juce::File& file)
+    {
+        auto& registry = Registry::get();
+        const int numRings = juce::jmin(registry.numClaimed.load(), Registry::maxThreads);
+        const auto ticksPerMicrosecond = (double)juce::Time::getHighResolutionTicksPerSecond() / 1.0e6;
+        const int pid = 1;
+
+        juce::MemoryOutputStream json;
+        json << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+
+        bool first = true;
+        auto separator = [&json, &first] { json << (first ? "\n" : ",\n"); first = false; };
+
+        separator();
+        json << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << pid << ",\"args\":{\"name\":\"DREKAVAC\"}}";
+
+        std::vector<Event> events;
+        for (int i = 0; i < numRings; ++i)
+        {
+            const auto& ring = registry.rings[(size_t)i];
+            const auto tid = (juce::int64)ring.threadID.load();
+
+            // Host threads and anything else that never named itself
+            auto threadName = juce::String::fromUTF8(ring.threadName);
+            if (threadName.isEmpty())
+                threadName = "thread " + juce::String(i + 1);
+
+            separator();
+            json << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << pid << ",\"tid\":" << tid
+                 << ",\"args\":{\"name\":" << juce::JSON::toString(threadName) << "}}";
+
+            events.clear();
+            ring.copyTo(events);
+
+            for (const auto& event : events)
+            {
+                separator();
+                json << "{\"name\":\"" << event.name << "\",\"pid\":" << pid << ",\"tid\":" << tid
+                     << ",\"ts\":" << juce::String((double)event.start / ticksPerMicrosecond, 3);
+
+                if (event.end == event.start)
+                    json << ",\"ph\":\"i\",\"s\":\"t\"}";
+                else
+                    json << ",\"ph\":\"X\",\"dur\":" << juce::String((double)(event.end - event.start) / ticksPerMicrosecond, 3) << "}";
+            }
+        }
+
+        json << "\n]}\n";
+        return file.replaceWithData(json.getData(), json.getDataSize());
+    }
+}
+
+ #define DREKAVAC_TRACE_SCOPE(name)   const Trace::Scope JUCE_JOIN_MACRO(drekavacTraceScope, __LINE__){ "" name }
+ #define DREKAVAC_TRACE_INSTANT(name) Trace::instant("" name)
+ #define DREKAVAC_TRACE_THREAD_NAME(name) Trace::nameThread(name)
+
+#else
+
+ #define DREKAVAC_TRACE_SCOPE(name)
+ #define DREKAVAC_TRACE_INSTANT(name)
+ #define DREKAVAC_TRACE_THREAD_NAME(name)
+
+#endif
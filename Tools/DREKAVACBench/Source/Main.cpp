@@ -0,0 +1,689 @@
+#include <JuceHeader.h>
+#include <functional>
+#include <iostream>
+#include <thread>
+#include "../../../Source/PluginProcessor.h"
+
+//==============================================================================
+// Headless benchmark and regression harness for the DREKAVAC chain.
+//
+//   DREKAVACBench [--seconds=5] [--quick] [--channels=2] [--kernel=fused|reference|both]
+//                 [--golden[=<dir>]] [--write-golden] [--tolerance=1e-4] [--instances=N]
+//                 [--trace=<file.json>] [--realtime-check] [--trap]
+//
+// Without --golden it sweeps sample rate, block size, oversampling, quality and
+// automation and prints the cost of each combination, on a bus of --channels,
+// with the fused nonlinear kernel, the per-stage reference path or both. With --golden it renders
+// a fixed set of configurations and compares them against the WAV files in
+// <dir>, or rewrites those files when --write-golden is given. Without a <dir>
+// it uses the reference renders kept in Tools/DREKAVACBench/Golden, found by
+// walking up from the executable. The exit code is non-zero when any render is
+// missing or differs by more than the tolerance.
+// With --instances it prepares N processors side by side, as a large session
+// would, and prints what each one holds and what they share. --trace saves the
+// timeline of the run as Chrome trace JSON, in builds with DREKAVAC_ENABLE_TRACING.
+// --realtime-check, in builds with DREKAVAC_REALTIME_CHECKS (the Debug
+// configuration), sweeps every setting and flips presets while audio runs, and
+// fails if the audio thread allocated, locked, waited, slept, touched a file or
+// posted a message. It first makes one such call of each kind itself, to show
+// which kinds the hooks catch on this platform and which go unchecked there.
+// --trap stops at the first such call instead of counting them.
+
+namespace
+{
+    struct RenderConfig
+    {
+        double sampleRate = 48000.0;
+        int blockSize = 256;
+        int oversampling = 2;   // choice index: 1x, 2x, 4x, 8x
+        int quality = 1;        // choice index: Auto, Realtime, Render
+        bool automate = false;
+        int numChannels = 2;
+        bool referenceKernel = false;
+
+        juce::String getName() const
+        {
+            static const char* factors[] = { "1x", "2x", "4x", "8x" };
+            static const char* qualities[] = { "auto", "realtime", "render" };
+
+            return juce::String((int)sampleRate) + "_" + juce::String(blockSize) + "_"
+                 + (quality == 2 ? "8x" : factors[oversampling]) + "_" + qualities[quality]
+                 + (automate ? "_automated" : "_static")
+                 + (numChannels != 2 ? "_" + juce::String(numChannels) + "ch" : juce::String())
+                 + (referenceKernel ? "_reference" : "");
+        }
+    };
+
+    struct RenderResult
+    {
+        juce::AudioBuffer<float> output;
+        double processSeconds = 0.0;
+        ProcessingStats stats;
+    };
+
+    void setParameter(DREKAVACAudioProcessor& processor, const char* parameterID, float value)
+    {
+        if (auto* parameter = processor.parameters.getParameter(parameterID))
+            parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+    }
+
+    // Same program every run, so renders are comparable across builds
+    void resetParameters(DREKAVACAudioProcessor& processor)
+    {
+        for (auto* id : DREKAVACAudioProcessor::parameterIDs)
+            if (auto* parameter = processor.parameters.getParameter(id))
+                parameter->setValueNotifyingHost(parameter->getDefaultValue());
+
+        setParameter(processor, "drive", 6.0f);
+        setParameter(processor, "distortion", 4.0f);
+        setParameter(processor, "fold", 0.4f);
+        setParameter(processor, "drywet", 1.0f);
+    }
+
+    // Slow sweeps over the knobs that drive coefficient updates
+    void automate(DREKAVACAudioProcessor& processor, double timeSeconds)
+    {
+        const auto twoPi = juce::MathConstants<double>::twoPi;
+
+        setParameter(processor, "drive", (float)(5.0 + 4.5 * std::sin(twoPi * timeSeconds / 2.0)));
+        setParameter(processor, "tone", (float)(0.5 + 0.45 * std::sin(twoPi * timeSeconds / 1.7)));
+        setParameter(processor, "cutoff", (float)(0.5 + 0.45 * std::sin(twoPi * timeSeconds / 1.3)));
+        setParameter(processor, "fold", (float)(0.5 + 0.4 * std::sin(twoPi * timeSeconds / 0.9)));
+        setParameter(processor, "flavor", (float)(0.5 + 0.5 * std::sin(twoPi * timeSeconds / 3.1)));
+    }
+
+    // Two detuned partials, a high partial and a little noise, with a slow swell.
+    // Channels after the first two get their own noise and level.
+    juce::AudioBuffer<float> makeTestSignal(double sampleRate, int numSamples, int numChannels = 2)
+    {
+        juce::AudioBuffer<float> signal(numChannels, numSamples);
+        juce::Random random(1234);
+
+        const auto twoPi = juce::MathConstants<double>::twoPi;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const double t = i / sampleRate;
+            const double swell = 0.5 + 0.45 * std::sin(twoPi * 0.25 * t);
+            const double tone = 0.6 * std::sin(twoPi * 110.0 * t) + 0.3 * std::sin(twoPi * 221.5 * t)
+                              + 0.1 * std::sin(twoPi * 3520.0 * t);
+
+            signal.setSample(0, i, (float)(swell * tone) + 0.01f * (random.nextFloat() * 2.0f - 1.0f));
+            signal.setSample(1, i, (float)(swell * tone * 0.9) + 0.01f * (random.nextFloat() * 2.0f - 1.0f));
+
+            for (int ch = 2; ch < numChannels; ++ch)
+                signal.setSample(ch, i, (float)(swell * tone * (1.0 - 0.05 * ch)) + 0.01f * (random.nextFloat() * 2.0f - 1.0f));
+        }
+
+        return signal;
+    }
+
+    RenderResult render(const RenderConfig& config, const juce::AudioBuffer<float>& input)
+    {
+        DREKAVACAudioProcessor processor;
+        resetParameters(processor);
+        setParameter(processor, "oversampling", (float)config.oversampling);
+        setParameter(processor, "quality", (float)config.quality);
+        processor.setFusedKernelEnabled(!config.referenceKernel);
+
+        // prepareToPlay builds the oversampler itself, so no message loop is needed
+        const int numChannels = input.getNumChannels();
+        processor.setPlayConfigDetails(numChannels, numChannels, config.sampleRate, config.blockSize);
+        processor.prepareToPlay(config.sampleRate, config.blockSize);
+
+        RenderResult result;
+        result.output.setSize(numChannels, input.getNumSamples());
+
+        juce::AudioBuffer<float> block(numChannels, config.blockSize);
+        juce::MidiBuffer midi;
+        juce::int64 ticks = 0;
+
+        for (int start = 0; start < input.getNumSamples(); start += config.blockSize)
+        {
+            const int numSamples = juce::jmin(config.blockSize, input.getNumSamples() - start);
+            block.setSize(numChannels, numSamples, false, false, true);
+
+            for (int ch = 0; ch < numChannels; ++ch)
+                block.copyFrom(ch, 0, input, ch, start, numSamples);
+
+            const auto before = juce::Time::getHighResolutionTicks();
+
+            if (config.automate)
+                automate(processor, start / config.sampleRate);
+
+            processor.processBlock(block, midi);
+            ticks += juce::Time::getHighResolutionTicks() - before;
+
+            for (int ch = 0; ch < numChannels; ++ch)
+                result.output.copyFrom(ch, start, block, ch, 0, numSamples);
+        }
+
+        result.processSeconds = juce::Time::highResolutionTicksToSeconds(ticks);
+        result.stats = processor.getProcessingStats();
+        processor.releaseResources();
+        return result;
+    }
+
+    //==============================================================================
+
+    int runSweep(double seconds, bool quick, int numChannels, const juce::String& kernel)
+    {
+        std::vector<bool> referenceKernels;
+        if (kernel != "reference")
+            referenceKernels.push_back(false);
+        if (kernel == "reference" || kernel == "both")
+            referenceKernels.push_back(true);
+
+        const std::vector<double> sampleRates = quick ? std::vector<double>{ 48000.0 }
+                                                      : std::vector<double>{ 44100.0, 48000.0, 96000.0 };
+        const std::vector<int> blockSizes = quick ? std::vector<int>{ 256 } : std::vector<int>{ 32, 128, 512 };
+
+        std::cout << juce::String("config").paddedRight(' ', 50) << "  ns/sample    x realtime   peak block us\n";
+
+        for (auto sampleRate : sampleRates)
+        {
+            const auto input = makeTestSignal(sampleRate, (int)(seconds * sampleRate), numChannels);
+
+            for (auto blockSize : blockSizes)
+                for (int quality : { 1, 2 })
+                    for (int oversampling = 0; oversampling < 4; ++oversampling)
+                    {
+                        // Render quality always runs 8x
+                        if (quality == 2 && oversampling != 3)
+                            continue;
+
+                        for (bool automated : { false, true })
+                            for (bool referenceKernel : referenceKernels)
+                            {
+                                const RenderConfig config{ sampleRate, blockSize, oversampling, quality, automated,
+                                                           numChannels, referenceKernel };
+                                const auto result = render(config, input);
+
+                                const double nsPerSample = 1.0e9 * result.processSeconds / input.getNumSamples();
+                                const double realtimeFactor = seconds / juce::jmax(1.0e-9, result.processSeconds);
+
+                                std::cout << config.getName().paddedRight(' ', 50)
+                                          << juce::String(nsPerSample, 1).paddedLeft(' ', 11)
+                                          << juce::String(realtimeFactor, 1).paddedLeft(' ', 14)
+                                          << juce::String(result.stats.peakBlockMicroseconds, 1).paddedLeft(' ', 16)
+                                          << "\n";
+                            }
+                    }
+        }
+
+        return 0;
+    }
+
+    //==============================================================================
+
+   #if DREKAVAC_REALTIME_CHECKS
+    struct RealtimeCheckConfig
+    {
+        double sampleRate;
+        int blockSize;
+        int numChannels;
+        bool doublePrecision;
+
+        juce::String getName() const
+        {
+            return juce::String((int)sampleRate) + "_" + juce::String(blockSize) + "_" + juce::String(numChannels) + "ch"
+                 + (doublePrecision ? "_double" : "_float");
+        }
+    };
+
+    // Every choice and switch, stepped one change at a time so each lands in its own block
+    void stepSettings(DREKAVACAudioProcessor& processor, int step)
+    {
+        struct Setting { const char* id; int numValues; };
+        static const Setting settings[] = {
+            { "oversampling", 4 }, { "osfilter", 2 }, { "quality", 3 }, { "shaper", 2 }, { "compressor", 2 },
+            { "lookahead", 2 }, { "driveadaa", 2 }, { "distadaa", 2 }, { "foldadaa", 2 }, { "parallel", 2 },
+            { "clipadaa", 2 }
+        };
+
+        const auto& setting = settings[(size_t)step % std::size(settings)];
+        const int round = step / (int)std::size(settings);
+        setParameter(processor, setting.id, (float)((round + 1) % setting.numValues));
+    }
+
+    // Runs the whole processor the way a session would, from a thread of its own,
+    // while the message thread loads presets and rebuilds oversamplers under it.
+    // Returns the number of reports this configuration caused.
+    template <typename SampleType>
+    int runRealtimeCheck(const RealtimeCheckConfig& config, const juce::MemoryBlock& stateA, const juce::MemoryBlock& stateB)
+    {
+        const double seconds = 4.0;
+
+        // Built and torn down the way a host would, holding the message thread
+        std::unique_ptr<DREKAVACAudioProcessor> instance;
+        {
+            const juce::MessageManagerLock mml;
+            instance = std::make_unique<DREKAVACAudioProcessor>();
+        }
+
+        auto& processor = *instance;
+        resetParameters(processor);
+        processor.setProcessingPrecision(config.doublePrecision ? juce::AudioProcessor::doublePrecision
+                                                                : juce::AudioProcessor::singlePrecision);
+        processor.setPlayConfigDetails(config.numChannels, config.numChannels, config.sampleRate, config.blockSize);
+        processor.prepareToPlay(config.sampleRate, config.blockSize);
+
+        const auto signal = makeTestSignal(config.sampleRate, (int)(seconds * config.sampleRate), config.numChannels);
+        juce::AudioBuffer<SampleType> block(config.numChannels, config.blockSize);
+        juce::MidiBuffer midi;
+
+        RealtimeCheck::reset();
+        int blockIndex = 0;
+
+        for (int start = 0; start < signal.getNumSamples(); start += config.blockSize, ++blockIndex)
+        {
+            const int numSamples = juce::jmin(config.blockSize, signal.getNumSamples() - start);
+            block.setSize(config.numChannels, numSamples, false, false, true);
+
+            // A stretch of silence every second, so the idle path runs too
+            const bool silent = (start / (int)config.sampleRate) % 2 == 1 && (start % (int)config.sampleRate) < (int)(config.sampleRate / 4);
+            for (int ch = 0; ch < config.numChannels; ++ch)
+                for (int i = 0; i < numSamples; ++i)
+                    block.setSample(ch, i, silent ? SampleType(0) : (SampleType)signal.getSample(ch, start + i));
+
+            automate(processor, start / config.sampleRate);
+
+            if (blockIndex % 16 == 0)
+                stepSettings(processor, blockIndex / 16);
+
+            // Preset and program changes arrive from the message thread, mid-stream
+            if (blockIndex % 48 == 24)
+            {
+                const auto* state = (blockIndex / 48) % 2 == 0 ? &stateA : &stateB;
+                juce::MessageManager::callAsync([&processor, state] { processor.setStateInformation(state->getData(), (int)state->getSize()); });
+            }
+            else if (blockIndex % 96 == 60)
+            {
+                juce::MessageManager::callAsync([&processor] { processor.setCurrentProgram(0); });
+            }
+
+            if (blockIndex % 80 >= 72)
+                processor.processBlockBypassed(block, midi);
+            else
+                processor.processBlock(block, midi);
+
+            // Leaves the message thread room to build oversamplers between blocks
+            juce::Thread::sleep(1);
+        }
+
+        // Nothing queued may still point at this processor once it is gone
+        juce::WaitableEvent drained;
+        juce::MessageManager::callAsync([&drained] { drained.signal(); });
+        drained.wait();
+
+        processor.releaseResources();
+        const int numReports = RealtimeCheck::getNumViolations();
+
+        const juce::MessageManagerLock mml;
+        instance.reset();
+        return numReports;
+    }
+
+    // Makes one call of every kind on a marked thread and prints, per kind, whether
+    // the hooks caught it. A clean run proves little if a kind was never checked,
+    // so those are listed too. Returns false when a kind the hooks claim to cover
+    // got through.
+    bool runRealtimeSelfCheck()
+    {
+        struct NeverRuns : public juce::AsyncUpdater
+        {
+            void handleAsyncUpdate() override {}
+        };
+
+        const auto executable = juce::File::getSpecialLocation(juce::File::currentExecutableFile);
+        NeverRuns updater;
+        juce::CriticalSection section;
+        juce::WaitableEvent event;
+        void* volatile memory = nullptr;
+
+        const std::array<std::function<void()>, RealtimeCheck::numViolations> probes{
+            [&] { memory = ::operator new(64); },
+            [&] { ::operator delete(memory); },
+            [&] { const juce::ScopedLock sl(section); },
+            [&] { event.wait(1.0); },
+            [&] { juce::Thread::sleep(1); juce::Thread::yield(); },
+            [&] { juce::FileInputStream stream(executable); },
+            [&] { updater.triggerAsyncUpdate(); },
+        };
+
+        bool allCaught = true;
+        std::cout << "Self-check, one call of each kind on a marked thread:\n";
+
+        for (int kind = 0; kind < RealtimeCheck::numViolations; ++kind)
+        {
+            RealtimeCheck::reset();
+            {
+                DREKAVAC_REALTIME_SCOPE("selfCheck");
+                probes[(size_t)kind]();
+            }
+
+            // A post is caught as whatever the platform's queue does, not always as a post
+            const auto violation = (RealtimeCheck::Violation)kind;
+            const bool caught = violation == RealtimeCheck::messagePost ? RealtimeCheck::getNumViolations() > 0
+                                                                        : RealtimeCheck::getNumViolations(violation) > 0;
+            const auto* coverage = RealtimeCheck::getCoverage(violation);
+
+            std::cout << "  " << juce::String(RealtimeCheck::getName(kind)).paddedRight(' ', 16);
+
+            if (coverage == nullptr)
+                std::cout << (caught ? "caught, though nothing claims it" : "UNCHECKED on this platform");
+            else if (caught)
+                std::cout << "caught  (" << coverage << ")";
+            else
+                std::cout << "MISSED  (" << coverage << ")";
+
+            std::cout << "\n";
+            allCaught = allCaught && (caught || coverage == nullptr);
+        }
+
+        updater.cancelPendingUpdate();
+        RealtimeCheck::reset();
+        std::cout << "\n";
+        return allCaught;
+    }
+
+    int runRealtimeChecks(bool trap)
+    {
+        RealtimeCheck::installHooks();
+
+        // Trapping waits until the self-check has made its deliberate calls
+        if (!runRealtimeSelfCheck())
+        {
+            std::cout << "The hooks missed calls they claim to catch; not running the checks\n";
+            return 1;
+        }
+
+        RealtimeCheck::setTrapping(trap);
+
+        // Two states to flip between, far enough apart to rebuild the oversampler
+        juce::MemoryBlock stateA, stateB;
+        {
+            DREKAVACAudioProcessor processor;
+            resetParameters(processor);
+            processor.getStateInformation(stateA);
+
+            setParameter(processor, "oversampling", 3.0f);
+            setParameter(processor, "osfilter", 1.0f);
+            setParameter(processor, "lookahead", 1.0f);
+            setParameter(processor, "compressor", 1.0f);
+            setParameter(processor, "shaper", 1.0f);
+            processor.getStateInformation(stateB);
+        }
+
+        const RealtimeCheckConfig configs[] = {
+            { 44100.0, 31, 2, false },
+            { 48000.0, 64, 2, false },
+            { 48000.0, 256, 2, false },
+            { 96000.0, 1024, 2, false },
+            { 48000.0, 128, 2, true },
+            { 48000.0, 256, 6, false },
+        };
+
+        int failures = 0;
+        std::array<int, RealtimeCheck::numViolations> totals{};
+
+        std::thread audioThread([&]
+            {
+                for (const auto& config : configs)
+                {
+                    const int numReports = config.doublePrecision ? runRealtimeCheck<double>(config, stateA, stateB)
+                                                                  : runRealtimeCheck<float>(config, stateA, stateB);
+
+                    juce::String kinds;
+                    for (int kind = 0; kind < RealtimeCheck::numViolations; ++kind)
+                    {
+                        const int count = RealtimeCheck::getNumViolations((RealtimeCheck::Violation)kind);
+                        totals[(size_t)kind] += count;
+                        if (count > 0)
+                            kinds << "  " << count << " " << RealtimeCheck::getName(kind);
+                    }
+
+                    std::array<RealtimeCheck::Record, 4> records;
+                    const int numRecords = RealtimeCheck::getRecords(records.data(), (int)records.size());
+
+                    std::cout << (numReports == 0 ? "ok      " : "FAIL    ") << config.getName().paddedRight(' ', 24) << kinds << "\n";
+                    for (int i = 0; i < numRecords; ++i)
+                        std::cout << "          first: " << RealtimeCheck::getName(records[(size_t)i].violation)
+                                  << " in " << records[(size_t)i].scope << "\n";
+
+                    failures += numReports > 0 ? 1 : 0;
+                }
+
+                juce::MessageManager::getInstance()->stopDispatchLoop();
+            });
+
+        juce::MessageManager::getInstance()->runDispatchLoop();
+        audioThread.join();
+
+        std::cout << "\n" << failures << " of " << std::size(configs) << " configurations made calls an audio thread must not\n";
+
+        juce::StringArray unchecked;
+        for (int kind = 0; kind < RealtimeCheck::numViolations; ++kind)
+            if (RealtimeCheck::getCoverage((RealtimeCheck::Violation)kind) == nullptr)
+                unchecked.add(RealtimeCheck::getName(kind));
+
+        if (!unchecked.isEmpty())
+            std::cout << "Not checked on this platform: " << unchecked.joinIntoString(", ") << "\n";
+
+        return failures == 0 ? 0 : 1;
+    }
+   #endif
+
+    //==============================================================================
+
+    int runFootprint(int numInstances, int numChannels)
+    {
+        const double sampleRate = 48000.0;
+        const int blockSize = 256;
+
+        std::vector<std::unique_ptr<DREKAVACAudioProcessor>> processors;
+        const auto startTicks = juce::Time::getHighResolutionTicks();
+
+        for (int i = 0; i < numInstances; ++i)
+        {
+            processors.push_back(std::make_unique<DREKAVACAudioProcessor>());
+            processors.back()->setPlayConfigDetails(numChannels, numChannels, sampleRate, blockSize);
+            processors.back()->prepareToPlay(sampleRate, blockSize);
+        }
+
+        const auto seconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+
+        size_t instanceBytes = 0;
+        for (const auto& processor : processors)
+            instanceBytes += processor->getMemoryFootprint().instanceBytes;
+
+        const auto footprint = processors.front()->getMemoryFootprint();
+        auto kilobytes = [](double bytes) { return juce::String(bytes / 1024.0, 1) + " KB"; };
+
+        std::cout << numInstances << " instances, " << numChannels << " channels at " << (int)sampleRate << " Hz\n"
+                  << "  prepared in      " << juce::String(1000.0 * seconds, 1) << " ms ("
+                  << juce::String(1000.0 * seconds / numInstances, 2) << " ms each)\n"
+                  << "  per instance     ~" << kilobytes((double)instanceBytes / numInstances) << " (estimated)\n"
+                  << "  all instances    ~" << kilobytes((double)instanceBytes) << " (estimated)\n"
+                  << "  shared tables    " << kilobytes((double)footprint.sharedBytes) << ", "
+                  << footprint.numSharedTables << " tables, built " << footprint.numSharedTableBuilds << " times\n";
+
+        return 0;
+    }
+
+    //==============================================================================
+
+    std::vector<RenderConfig> getGoldenConfigs()
+    {
+        std::vector<RenderConfig> configs;
+
+        for (int oversampling = 0; oversampling < 4; ++oversampling)
+            configs.push_back({ 48000.0, 256, oversampling, 1, true });
+
+        configs.push_back({ 48000.0, 256, 3, 2, true });
+        configs.push_back({ 44100.0, 64, 2, 1, false });
+        return configs;
+    }
+
+    bool writeWav(const juce::File& file, const juce::AudioBuffer<float>& buffer, double sampleRate)
+    {
+        file.deleteFile();
+
+        std::unique_ptr<juce::OutputStream> stream(file.createOutputStream());
+        if (stream == nullptr)
+            return false;
+
+        juce::WavAudioFormat wav;
+        std::unique_ptr<juce::AudioFormatWriter> writer(
+            wav.createWriterFor(stream.get(), sampleRate, (unsigned int)buffer.getNumChannels(), 32, {}, 0));
+
+        if (writer == nullptr)
+            return false;
+
+        stream.release(); // now owned by the writer
+        return writer->writeFromAudioSampleBuffer(buffer, 0, buffer.getNumSamples());
+    }
+
+    bool readWav(const juce::File& file, juce::AudioBuffer<float>& buffer)
+    {
+        juce::AudioFormatManager formats;
+        formats.registerBasicFormats();
+
+        std::unique_ptr<juce::AudioFormatReader> reader(formats.createReaderFor(file));
+        if (reader == nullptr)
+            return false;
+
+        buffer.setSize((int)reader->numChannels, (int)reader->lengthInSamples);
+        return reader->read(&buffer, 0, (int)reader->lengthInSamples, 0, true, true);
+    }
+
+    // The Golden directory next to DREKAVACBench.jucer, wherever the build put the executable
+    juce::File getDefaultGoldenDirectory()
+    {
+        const auto executable = juce::File::getSpecialLocation(juce::File::currentExecutableFile);
+
+        for (auto dir = executable.getParentDirectory(); !dir.isRoot(); dir = dir.getParentDirectory())
+            if (dir.getChildFile("DREKAVACBench.jucer").existsAsFile())
+                return dir.getChildFile("Golden");
+
+        return juce::File::getCurrentWorkingDirectory().getChildFile("Golden");
+    }
+
+    int runGolden(const juce::File& directory, bool writeGolden, float tolerance)
+    {
+        // Short, so the renders stay small enough to keep in the tree
+        const double seconds = 1.0;
+        int failures = 0, numMissing = 0;
+
+        if (writeGolden && !directory.createDirectory())
+        {
+            std::cout << "Cannot create " << directory.getFullPathName() << "\n";
+            return 1;
+        }
+
+        for (const auto& config : getGoldenConfigs())
+        {
+            const auto input = makeTestSignal(config.sampleRate, (int)(seconds * config.sampleRate));
+            const auto result = render(config, input);
+            const auto file = directory.getChildFile(config.getName() + ".wav");
+
+            if (writeGolden)
+            {
+                const bool written = writeWav(file, result.output, config.sampleRate);
+                std::cout << (written ? "wrote   " : "FAILED  ") << file.getFileName() << "\n";
+                failures += written ? 0 : 1;
+                continue;
+            }
+
+            juce::AudioBuffer<float> golden;
+            if (!readWav(file, golden))
+            {
+                std::cout << "MISSING " << file.getFileName() << "\n";
+                ++failures;
+                ++numMissing;
+                continue;
+            }
+
+            if (golden.getNumChannels() != result.output.getNumChannels()
+                || golden.getNumSamples() != result.output.getNumSamples())
+            {
+                std::cout << "FAIL    " << file.getFileName() << "  length or channel count changed\n";
+                ++failures;
+                continue;
+            }
+
+            float maxError = 0.0f;
+            for (int ch = 0; ch < golden.getNumChannels(); ++ch)
+                for (int i = 0; i < golden.getNumSamples(); ++i)
+                    maxError = juce::jmax(maxError, std::abs(golden.getSample(ch, i) - result.output.getSample(ch, i)));
+
+            const bool passed = maxError <= tolerance;
+            std::cout << (passed ? "ok      " : "FAIL    ") << file.getFileName() << "  max error "
+                      << juce::String(juce::Decibels::gainToDecibels(maxError, -200.0f), 1) << " dB\n";
+            failures += passed ? 0 : 1;
+        }
+
+        if (numMissing > 0)
+            std::cout << "\n" << numMissing << " reference renders missing from " << directory.getFullPathName()
+                      << "\nCapture them from a build of this tree with\n"
+                      << "    DREKAVACBench --golden --write-golden\n"
+                      << "and commit them, as Golden/README.txt describes\n";
+
+        return failures == 0 ? 0 : 1;
+    }
+}
+
+//==============================================================================
+static int runBench(const juce::ArgumentList& args)
+{
+    if (args.containsOption("--realtime-check"))
+    {
+       #if DREKAVAC_REALTIME_CHECKS
+        return runRealtimeChecks(args.containsOption("--trap"));
+       #else
+        std::cout << "Realtime checks are compiled out; build with DREKAVAC_REALTIME_CHECKS=1\n";
+        return 1;
+       #endif
+    }
+
+    if (args.containsOption("--golden"))
+    {
+        const auto path = args.getValueForOption("--golden");
+        const auto directory = path.isNotEmpty() ? juce::File::getCurrentWorkingDirectory().getChildFile(path)
+                                                 : getDefaultGoldenDirectory();
+        const auto tolerance = args.containsOption("--tolerance") ? args.getValueForOption("--tolerance").getFloatValue()
+                                                                  : 1.0e-4f;
+
+        return runGolden(directory, args.containsOption("--write-golden"), tolerance);
+    }
+
+    const auto seconds = args.containsOption("--seconds") ? args.getValueForOption("--seconds").getDoubleValue() : 5.0;
+    const auto numChannels = args.containsOption("--channels") ? args.getValueForOption("--channels").getIntValue() : 2;
+
+    if (args.containsOption("--instances"))
+        return runFootprint(juce::jmax(1, args.getValueForOption("--instances").getIntValue()),
+                            juce::jlimit(1, 16, numChannels));
+
+    const auto kernel = args.containsOption("--kernel") ? args.getValueForOption("--kernel") : juce::String("fused");
+    return runSweep(juce::jmax(0.1, seconds), args.containsOption("--quick"), juce::jlimit(1, 16, numChannels), kernel);
+}
+
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    juce::ArgumentList args(argc, argv);
+
+    const auto result = runBench(args);
+
+    if (args.containsOption("--trace"))
+    {
+        const auto file = juce::File::getCurrentWorkingDirectory().getChildFile(args.getValueForOption("--trace"));
+#if DREKAVAC_ENABLE_TRACING
+        std::cout << (Trace::exportJson(file) ? "Trace written to " : "Cannot write ") << file.getFullPathName() << "\n";
+#else
+        std::cout << "Tracing is compiled out; build with DREKAVAC_ENABLE_TRACING=1 to write " << file.getFileName() << "\n";
+#endif
+    }
+
+    return result;
+}
@@ -0,0 +1,615 @@
+#include <JuceHeader.h>
+#include "../../../Source/RealtimeCheck.h"
+
+//==============================================================================
+// The harness side of RealtimeCheck: hooks that report calls an audio thread
+// must not make. Only compiled into realtime-check builds of the bench. What
+// each platform reaches is recorded with RealtimeCheck::setCoverage(), and the
+// bench prints every kind left unchecked before it runs.
+//
+// Allocations: the debug CRT's allocation hook on Windows, which sees malloc as
+// well as new; malloc and friends interposed on glibc; elsewhere only the global
+// operator new and delete are replaced, so plain malloc goes unseen.
+//
+// Windows: the bench's own import table is patched, so every call JUCE and the
+// plugin code make through it lands here first. That covers the Win32 lock,
+// wait, sleep, file and message-posting calls and the STL's mutex, condition
+// variable and yield entry points. Calls made inside other DLLs are not seen,
+// and neither is the STL when it is linked statically.
+//
+// Linux and BSD: the pthread lock, condition and semaphore calls, futex system
+// calls, sleeps, yields and file calls are interposed by name, resolving the real
+// ones with dlsym(RTLD_NEXT). JUCE posts messages there through a locked queue
+// and a socket write, so a post shows up as those.
+#if DREKAVAC_REALTIME_CHECKS
+
+#include <cstring>
+#include <new>
+
+#if JUCE_WINDOWS
+ #ifndef NOMINMAX
+  #define NOMINMAX
+ #endif
+ #include <windows.h>
+ #include <crtdbg.h>
+#elif JUCE_LINUX || JUCE_BSD
+ #include <atomic>
+ #include <cerrno>
+ #include <cstdarg>
+ #include <cstdio>
+ #include <dlfcn.h>
+ #include <fcntl.h>
+ #include <pthread.h>
+ #include <sched.h>
+ #include <semaphore.h>
+ #include <sys/syscall.h>
+ #include <time.h>
+ #include <unistd.h>
+#endif
+
+#if JUCE_WINDOWS && defined(_DEBUG)
+ #define DREKAVAC_CRT_ALLOC_HOOK 1
+#else
+ #define DREKAVAC_CRT_ALLOC_HOOK 0
+#endif
+
+#if (JUCE_LINUX || JUCE_BSD) && defined(__GLIBC__)
+ #define DREKAVAC_MALLOC_HOOK 1
+#else
+ #define DREKAVAC_MALLOC_HOOK 0
+#endif
+
+using RealtimeCheck::report;
+
+//==============================================================================
+#if DREKAVAC_CRT_ALLOC_HOOK
+
+namespace
+{
+    int __cdecl allocationHook(int allocationType, void*, size_t, int blockType, long, const unsigned char*, int)
+    {
+        // The CRT's own bookkeeping blocks must be left alone, or the hook recurses
+        if (blockType != _CRT_BLOCK)
+            report(allocationType == _HOOK_FREE ? RealtimeCheck::deallocation : RealtimeCheck::allocation);
+
+        return TRUE;
+    }
+}
+
+#elif DREKAVAC_MALLOC_HOOK
+
+// glibc exports its allocator under these names too, so forwarding needs no dlsym,
+// which would itself allocate. operator new goes through malloc and is seen here.
+extern "C"
+{
+    void* __libc_malloc(size_t);
+    void* __libc_calloc(size_t, size_t);
+    void* __libc_realloc(void*, size_t);
+    void* __libc_memalign(size_t, size_t);
+    void __libc_free(void*);
+
+    void* malloc(size_t size)
+    {
+        report(RealtimeCheck::allocation);
+        return __libc_malloc(size);
+    }
+
+    void* calloc(size_t count, size_t size)
+    {
+        report(RealtimeCheck::allocation);
+        return __libc_calloc(count, size);
+    }
+
+    void* realloc(void* memory, size_t size)
+    {
+        report(RealtimeCheck::allocation);
+        return __libc_realloc(memory, size);
+    }
+
+    void* aligned_alloc(size_t alignment, size_t size)
+    {
+        report(RealtimeCheck::allocation);
+        return __libc_memalign(alignment, size);
+    }
+
+    int posix_memalign(void** memory, size_t alignment, size_t size)
+    {
+        report(RealtimeCheck::allocation);
+        *memory = __libc_memalign(alignment, size);
+        return *memory != nullptr || size == 0 ? 0 : ENOMEM;
+    }
+
+    void free(void* memory)
+    {
+        if (memory != nullptr)
+            report(RealtimeCheck::deallocation);
+
+        __libc_free(memory);
+    }
+}
+
+#else
+
+void* operator new(std::size_t size)
+{
+    report(RealtimeCheck::allocation);
+
+    if (auto* memory = std::malloc(size > 0 ? size : 1))
+        return memory;
+
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    report(RealtimeCheck::allocation);
+    return std::malloc(size > 0 ? size : 1);
+}
+
+void* operator new[](std::size_t size) { return operator new(size); }
+void* operator new[](std::size_t size, const std::nothrow_t& tag) noexcept { return operator new(size, tag); }
+
+void operator delete(void* memory) noexcept
+{
+    if (memory != nullptr)
+        report(RealtimeCheck::deallocation);
+
+    std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept { operator delete(memory); }
+void operator delete(void* memory, std::size_t) noexcept { operator delete(memory); }
+void operator delete[](void* memory, std::size_t) noexcept { operator delete(memory); }
+
+#endif
+
+//==============================================================================
+#if JUCE_WINDOWS
+
+namespace
+{
+    // Each hook reports, then forwards to whatever the import table held before
+    decltype(&::EnterCriticalSection) realEnterCriticalSection = nullptr;
+    decltype(&::AcquireSRWLockExclusive) realAcquireSRWLockExclusive = nullptr;
+    decltype(&::AcquireSRWLockShared) realAcquireSRWLockShared = nullptr;
+    decltype(&::WaitForSingleObject) realWaitForSingleObject = nullptr;
+    decltype(&::WaitForMultipleObjects) realWaitForMultipleObjects = nullptr;
+    decltype(&::SleepConditionVariableCS) realSleepConditionVariableCS = nullptr;
+    decltype(&::SleepConditionVariableSRW) realSleepConditionVariableSRW = nullptr;
+    decltype(&::Sleep) realSleep = nullptr;
+    decltype(&::SleepEx) realSleepEx = nullptr;
+    decltype(&::SwitchToThread) realSwitchToThread = nullptr;
+    decltype(&::CreateFileW) realCreateFileW = nullptr;
+    decltype(&::ReadFile) realReadFile = nullptr;
+    decltype(&::WriteFile) realWriteFile = nullptr;
+    decltype(&::PostMessageW) realPostMessageW = nullptr;
+    decltype(&::PostThreadMessageW) realPostThreadMessageW = nullptr;
+
+    // The STL's exports take opaque handles; pointers are all the ABI needs
+    int (__cdecl* realMtxLock)(void*) = nullptr;
+    int (__cdecl* realCndWait)(void*, void*) = nullptr;
+    int (__cdecl* realCndTimedWait)(void*, void*, const void*) = nullptr;
+    void (__cdecl* realThrdYield)() = nullptr;
+
+    void WINAPI checkedEnterCriticalSection(LPCRITICAL_SECTION section)
+    {
+        report(RealtimeCheck::lock);
+        realEnterCriticalSection(section);
+    }
+
+    void WINAPI checkedAcquireSRWLockExclusive(PSRWLOCK srwLock)
+    {
+        report(RealtimeCheck::lock);
+        realAcquireSRWLockExclusive(srwLock);
+    }
+
+    void WINAPI checkedAcquireSRWLockShared(PSRWLOCK srwLock)
+    {
+        report(RealtimeCheck::lock);
+        realAcquireSRWLockShared(srwLock);
+    }
+
+    DWORD WINAPI checkedWaitForSingleObject(HANDLE handle, DWORD milliseconds)
+    {
+        report(RealtimeCheck::wait);
+        return realWaitForSingleObject(handle, milliseconds);
+    }
+
+    DWORD WINAPI checkedWaitForMultipleObjects(DWORD count, const HANDLE* handles, BOOL waitAll, DWORD milliseconds)
+    {
+        report(RealtimeCheck::wait);
+        return realWaitForMultipleObjects(count, handles, waitAll, milliseconds);
+    }
+
+    BOOL WINAPI checkedSleepConditionVariableCS(PCONDITION_VARIABLE condition, PCRITICAL_SECTION section, DWORD milliseconds)
+    {
+        report(RealtimeCheck::wait);
+        return realSleepConditionVariableCS(condition, section, milliseconds);
+    }
+
+    BOOL WINAPI checkedSleepConditionVariableSRW(PCONDITION_VARIABLE condition, PSRWLOCK srwLock, DWORD milliseconds, ULONG flags)
+    {
+        report(RealtimeCheck::wait);
+        return realSleepConditionVariableSRW(condition, srwLock, milliseconds, flags);
+    }
+
+    void WINAPI checkedSleep(DWORD milliseconds)
+    {
+        report(RealtimeCheck::sleep);
+        realSleep(milliseconds);
+    }
+
+    DWORD WINAPI checkedSleepEx(DWORD milliseconds, BOOL alertable)
+    {
+        report(RealtimeCheck::sleep);
+        return realSleepEx(milliseconds, alertable);
+    }
+
+    BOOL WINAPI checkedSwitchToThread()
+    {
+        report(RealtimeCheck::sleep);
+        return realSwitchToThread();
+    }
+
+    HANDLE WINAPI checkedCreateFileW(LPCWSTR name, DWORD access, DWORD share, LPSECURITY_ATTRIBUTES security,
+                                     DWORD disposition, DWORD flags, HANDLE temp)
+    {
+        report(RealtimeCheck::fileAccess);
+        return realCreateFileW(name, access, share, security, disposition, flags, temp);
+    }
+
+    BOOL WINAPI checkedReadFile(HANDLE file, LPVOID buffer, DWORD numBytes, LPDWORD numRead, LPOVERLAPPED overlapped)
+    {
+        report(RealtimeCheck::fileAccess);
+        return realReadFile(file, buffer, numBytes, numRead, overlapped);
+    }
+
+    BOOL WINAPI checkedWriteFile(HANDLE file, LPCVOID buffer, DWORD numBytes, LPDWORD numWritten, LPOVERLAPPED overlapped)
+    {
+        report(RealtimeCheck::fileAccess);
+        return realWriteFile(file, buffer, numBytes, numWritten, overlapped);
+    }
+
+    BOOL WINAPI checkedPostMessageW(HWND window, UINT message, WPARAM wParam, LPARAM lParam)
+    {
+        report(RealtimeCheck::messagePost);
+        return realPostMessageW(window, message, wParam, lParam);
+    }
+
+    BOOL WINAPI checkedPostThreadMessageW(DWORD threadID, UINT message, WPARAM wParam, LPARAM lParam)
+    {
+        report(RealtimeCheck::messagePost);
+        return realPostThreadMessageW(threadID, message, wParam, lParam);
+    }
+
+    int __cdecl checkedMtxLock(void* mutex)
+    {
+        report(RealtimeCheck::lock);
+        return realMtxLock(mutex);
+    }
+
+    int __cdecl checkedCndWait(void* condition, void* mutex)
+    {
+        report(RealtimeCheck::wait);
+        return realCndWait(condition, mutex);
+    }
+
+    int __cdecl checkedCndTimedWait(void* condition, void* mutex, const void* target)
+    {
+        report(RealtimeCheck::wait);
+        return realCndTimedWait(condition, mutex, target);
+    }
+
+    void __cdecl checkedThrdYield()
+    {
+        report(RealtimeCheck::sleep);
+        realThrdYield();
+    }
+
+    struct ImportPatch
+    {
+        const char* name;
+        RealtimeCheck::Violation violation;
+        void** original;
+        void* replacement;
+    };
+
+    const ImportPatch importPatches[] = {
+        { "EnterCriticalSection",      RealtimeCheck::lock,        (void**)&realEnterCriticalSection,      (void*)&checkedEnterCriticalSection },
+        { "AcquireSRWLockExclusive",   RealtimeCheck::lock,        (void**)&realAcquireSRWLockExclusive,   (void*)&checkedAcquireSRWLockExclusive },
+        { "AcquireSRWLockShared",      RealtimeCheck::lock,        (void**)&realAcquireSRWLockShared,      (void*)&checkedAcquireSRWLockShared },
+        { "WaitForSingleObject",       RealtimeCheck::wait,        (void**)&realWaitForSingleObject,       (void*)&checkedWaitForSingleObject },
+        { "WaitForMultipleObjects",    RealtimeCheck::wait,        (void**)&realWaitForMultipleObjects,    (void*)&checkedWaitForMultipleObjects },
+        { "SleepConditionVariableCS",  RealtimeCheck::wait,        (void**)&realSleepConditionVariableCS,  (void*)&checkedSleepConditionVariableCS },
+        { "SleepConditionVariableSRW", RealtimeCheck::wait,        (void**)&realSleepConditionVariableSRW, (void*)&checkedSleepConditionVariableSRW },
+        { "Sleep",                     RealtimeCheck::sleep,       (void**)&realSleep,                     (void*)&checkedSleep },
+        { "SleepEx",                   RealtimeCheck::sleep,       (void**)&realSleepEx,                   (void*)&checkedSleepEx },
+        { "SwitchToThread",            RealtimeCheck::sleep,       (void**)&realSwitchToThread,            (void*)&checkedSwitchToThread },
+        { "CreateFileW",               RealtimeCheck::fileAccess,  (void**)&realCreateFileW,               (void*)&checkedCreateFileW },
+        { "ReadFile",                  RealtimeCheck::fileAccess,  (void**)&realReadFile,                  (void*)&checkedReadFile },
+        { "WriteFile",                 RealtimeCheck::fileAccess,  (void**)&realWriteFile,                 (void*)&checkedWriteFile },
+        { "PostMessageW",              RealtimeCheck::messagePost, (void**)&realPostMessageW,              (void*)&checkedPostMessageW },
+        { "PostThreadMessageW",        RealtimeCheck::messagePost, (void**)&realPostThreadMessageW,        (void*)&checkedPostThreadMessageW },
+        { "_Mtx_lock",                 RealtimeCheck::lock,        (void**)&realMtxLock,                   (void*)&checkedMtxLock },
+        { "_Cnd_wait",                 RealtimeCheck::wait,        (void**)&realCndWait,                   (void*)&checkedCndWait },
+        { "_Cnd_timedwait",            RealtimeCheck::wait,        (void**)&realCndTimedWait,              (void*)&checkedCndTimedWait },
+        { "_Thrd_yield",               RealtimeCheck::sleep,       (void**)&realThrdYield,                 (void*)&checkedThrdYield },
+    };
+
+    // Points every matching import of this executable at its hook and marks the
+    // kinds that got at least one, returns how many imports were found
+    int patchImportTable()
+    {
+        auto* base = reinterpret_cast<BYTE*>(GetModuleHandleW(nullptr));
+        auto* dosHeader = reinterpret_cast<IMAGE_DOS_HEADER*>(base);
+        auto* ntHeaders = reinterpret_cast<IMAGE_NT_HEADERS*>(base + dosHeader->e_lfanew);
+        const auto& directory = ntHeaders->OptionalHeader.DataDirectory[IMAGE_DIRECTORY_ENTRY_IMPORT];
+
+        if (directory.VirtualAddress == 0)
+            return 0;
+
+        int numPatched = 0;
+
+        for (auto* module = reinterpret_cast<IMAGE_IMPORT_DESCRIPTOR*>(base + directory.VirtualAddress); module->Name != 0; ++module)
+        {
+            if (module->OriginalFirstThunk == 0)
+                continue; // no name table to match against
+
+            auto* names = reinterpret_cast<IMAGE_THUNK_DATA*>(base + module->OriginalFirstThunk);
+            auto* addresses = reinterpret_cast<IMAGE_THUNK_DATA*>(base + module->FirstThunk);
+
+            for (; names->u1.AddressOfData != 0; ++names, ++addresses)
+            {
+                if (IMAGE_SNAP_BY_ORDINAL(names->u1.Ordinal))
+                    continue;
+
+                const auto* import = reinterpret_cast<IMAGE_IMPORT_BY_NAME*>(base + names->u1.AddressOfData);
+
+                for (const auto& patch : importPatches)
+                {
+                    if (std::strcmp(reinterpret_cast<const char*>(import->Name), patch.name) != 0)
+                        continue;
+
+                    if (*patch.original == nullptr)
+                        *patch.original = reinterpret_cast<void*>(addresses->u1.Function);
+
+                    DWORD protection = 0;
+                    VirtualProtect(&addresses->u1.Function, sizeof(addresses->u1.Function), PAGE_READWRITE, &protection);
+                    addresses->u1.Function = reinterpret_cast<ULONG_PTR>(patch.replacement);
+                    VirtualProtect(&addresses->u1.Function, sizeof(addresses->u1.Function), protection, &protection);
+
+                    RealtimeCheck::setCoverage(patch.violation, "patched imports");
+                    ++numPatched;
+                    break;
+                }
+            }
+        }
+
+        return numPatched;
+    }
+}
+
+//==============================================================================
+#elif JUCE_LINUX || JUCE_BSD
+
+namespace
+{
+    // Resolved on first use through a plain atomic: a function-local static would
+    // take the guard, and the guard's futex call would land back in these hooks
+    template <typename Function>
+    Function getReal(std::atomic<void*>& slot, const char* name) noexcept
+    {
+        auto* function = slot.load(std::memory_order_acquire);
+
+        if (function == nullptr)
+        {
+            function = dlsym(RTLD_NEXT, name);
+            slot.store(function, std::memory_order_release);
+        }
+
+        return reinterpret_cast<Function>(function);
+    }
+
+    std::atomic<void*> realMutexLock{ nullptr }, realReadLock{ nullptr }, realWriteLock{ nullptr };
+    std::atomic<void*> realCondWait{ nullptr }, realCondTimedWait{ nullptr }, realCondClockWait{ nullptr };
+    std::atomic<void*> realSemWait{ nullptr }, realSemTimedWait{ nullptr }, realSyscall{ nullptr };
+    std::atomic<void*> realNanosleep{ nullptr }, realClockNanosleep{ nullptr }, realUsleep{ nullptr }, realYield{ nullptr };
+    std::atomic<void*> realOpen{ nullptr }, realOpenAt{ nullptr }, realFopen{ nullptr }, realRead{ nullptr }, realWrite{ nullptr };
+
+    // open() and openat() only get a mode argument when these flags ask for
+    // one, and reading it when it was not passed is undefined. O_TMPFILE shares
+    // bits with O_DIRECTORY, so all of it has to be set.
+    bool takesMode(int flags) noexcept
+    {
+       #ifdef O_TMPFILE
+        if ((flags & O_TMPFILE) == O_TMPFILE)
+            return true;
+       #endif
+
+        return (flags & O_CREAT) != 0;
+    }
+}
+
+extern "C"
+{
+    int pthread_mutex_lock(pthread_mutex_t* mutex)
+    {
+        report(RealtimeCheck::lock);
+        return getReal<int (*)(pthread_mutex_t*)>(realMutexLock, "pthread_mutex_lock")(mutex);
+    }
+
+    int pthread_rwlock_rdlock(pthread_rwlock_t* rwLock)
+    {
+        report(RealtimeCheck::lock);
+        return getReal<int (*)(pthread_rwlock_t*)>(realReadLock, "pthread_rwlock_rdlock")(rwLock);
+    }
+
+    int pthread_rwlock_wrlock(pthread_rwlock_t* rwLock)
+    {
+        report(RealtimeCheck::lock);
+        return getReal<int (*)(pthread_rwlock_t*)>(realWriteLock, "pthread_rwlock_wrlock")(rwLock);
+    }
+
+    int pthread_cond_wait(pthread_cond_t* condition, pthread_mutex_t* mutex)
+    {
+        report(RealtimeCheck::wait);
+        return getReal<int (*)(pthread_cond_t*, pthread_mutex_t*)>(realCondWait, "pthread_cond_wait")(condition, mutex);
+    }
+
+    int pthread_cond_timedwait(pthread_cond_t* condition, pthread_mutex_t* mutex, const struct timespec* target)
+    {
+        report(RealtimeCheck::wait);
+        return getReal<int (*)(pthread_cond_t*, pthread_mutex_t*, const struct timespec*)>(realCondTimedWait, "pthread_cond_timedwait")
+            (condition, mutex, target);
+    }
+
+    // What libstdc++'s condition_variable uses on newer glibc
+    int pthread_cond_clockwait(pthread_cond_t* condition, pthread_mutex_t* mutex, clockid_t clock, const struct timespec* target)
+    {
+        report(RealtimeCheck::wait);
+
+        using Function = int (*)(pthread_cond_t*, pthread_mutex_t*, clockid_t, const struct timespec*);
+        if (auto real = getReal<Function>(realCondClockWait, "pthread_cond_clockwait"))
+            return real(condition, mutex, clock, target);
+
+        return ENOSYS;
+    }
+
+    int sem_wait(sem_t* semaphore)
+    {
+        report(RealtimeCheck::wait);
+        return getReal<int (*)(sem_t*)>(realSemWait, "sem_wait")(semaphore);
+    }
+
+    int sem_timedwait(sem_t* semaphore, const struct timespec* target)
+    {
+        report(RealtimeCheck::wait);
+        return getReal<int (*)(sem_t*, const struct timespec*)>(realSemTimedWait, "sem_timedwait")(semaphore, target);
+    }
+
+    // Futexes are how everything above blocks, and what code calling the kernel
+    // directly (atomic waits, the static-init guard) uses. A system call takes at
+    // most six register-sized arguments, so they are forwarded as such.
+    long syscall(long number, ...)
+    {
+        va_list args;
+        va_start(args, number);
+        long a[6];
+        for (auto& argument : a)
+            argument = va_arg(args, long);
+        va_end(args);
+
+       #ifdef SYS_futex
+        if (number == SYS_futex)
+            report(RealtimeCheck::wait);
+       #endif
+
+        return getReal<long (*)(long, ...)>(realSyscall, "syscall")(number, a[0], a[1], a[2], a[3], a[4], a[5]);
+    }
+
+    int nanosleep(const struct timespec* duration, struct timespec* remaining)
+    {
+        report(RealtimeCheck::sleep);
+        return getReal<int (*)(const struct timespec*, struct timespec*)>(realNanosleep, "nanosleep")(duration, remaining);
+    }
+
+    int clock_nanosleep(clockid_t clock, int flags, const struct timespec* duration, struct timespec* remaining)
+    {
+        report(RealtimeCheck::sleep);
+        return getReal<int (*)(clockid_t, int, const struct timespec*, struct timespec*)>(realClockNanosleep, "clock_nanosleep")
+            (clock, flags, duration, remaining);
+    }
+
+    int usleep(useconds_t microseconds)
+    {
+        report(RealtimeCheck::sleep);
+        return getReal<int (*)(useconds_t)>(realUsleep, "usleep")(microseconds);
+    }
+
+    int sched_yield()
+    {
+        report(RealtimeCheck::sleep);
+        return getReal<int (*)()>(realYield, "sched_yield")();
+    }
+
+    // The mode is only read, and passed on, when the flags ask for one
+    int open(const char* path, int flags, ...)
+    {
+        report(RealtimeCheck::fileAccess);
+
+        auto real = getReal<int (*)(const char*, int, ...)>(realOpen, "open");
+        if (!takesMode(flags))
+            return real(path, flags);
+
+        va_list args;
+        va_start(args, flags);
+        const auto mode = va_arg(args, unsigned int);
+        va_end(args);
+
+        return real(path, flags, mode);
+    }
+
+    int openat(int directory, const char* path, int flags, ...)
+    {
+        report(RealtimeCheck::fileAccess);
+
+        auto real = getReal<int (*)(int, const char*, int, ...)>(realOpenAt, "openat");
+        if (!takesMode(flags))
+            return real(directory, path, flags);
+
+        va_list args;
+        va_start(args, flags);
+        const auto mode = va_arg(args, unsigned int);
+        va_end(args);
+
+        return real(directory, path, flags, mode);
+    }
+
+    FILE* fopen(const char* path, const char* mode)
+    {
+        report(RealtimeCheck::fileAccess);
+        return getReal<FILE* (*)(const char*, const char*)>(realFopen, "fopen")(path, mode);
+    }
+
+    ssize_t read(int file, void* buffer, size_t numBytes)
+    {
+        report(RealtimeCheck::fileAccess);
+        return getReal<ssize_t (*)(int, void*, size_t)>(realRead, "read")(file, buffer, numBytes);
+    }
+
+    ssize_t write(int file, const void* buffer, size_t numBytes)
+    {
+        report(RealtimeCheck::fileAccess);
+        return getReal<ssize_t (*)(int, const void*, size_t)>(realWrite, "write")(file, buffer, numBytes);
+    }
+}
+
+#endif
+
+//==============================================================================
+void RealtimeCheck::installHooks()
+{
+   #if DREKAVAC_CRT_ALLOC_HOOK
+    _CrtSetAllocHook(allocationHook);
+    setCoverage(allocation, "debug CRT allocation hook");
+    setCoverage(deallocation, "debug CRT allocation hook");
+   #elif DREKAVAC_MALLOC_HOOK
+    setCoverage(allocation, "malloc family, interposed");
+    setCoverage(deallocation, "free, interposed");
+   #else
+    setCoverage(allocation, "operator new only, plain malloc is unseen");
+    setCoverage(deallocation, "operator delete only, plain free is unseen");
+   #endif
+
+   #if JUCE_WINDOWS
+    patchImportTable();
+   #elif JUCE_LINUX || JUCE_BSD
+    setCoverage(lock, "pthread mutex and rwlock, interposed");
+    setCoverage(wait, "pthread condition, semaphore and futex calls, interposed");
+    setCoverage(sleep, "nanosleep, usleep and sched_yield, interposed");
+    setCoverage(fileAccess, "open, fopen, read and write, interposed");
+    setCoverage(messagePost, "as the lock and socket write of JUCE's message queue");
+   #endif
+}
+
+#endif
@@ -0,0 +1,351 @@
+#include <JuceHeader.h>
+#include <iostream>
+#include "../../../Source/PluginProcessor.h"
+
+//==============================================================================
+// Offline batch renderer: runs audio files through DREKAVAC with a preset.
+//
+//   DREKAVACRender --preset=<file.preset> --out=<dir> [--threads=N]
+//                  [--block=4096] [--tail=<seconds>] <file or folder>...
+//
+// WAV, AIFF and FLAC inputs are streamed through in --block sized chunks and
+// written to <dir> under the same name and format, so memory stays bounded by
+// the chunk size whatever the file length. Files found in a folder keep their
+// path below it, and two inputs that would land on the same output stop the
+// run before anything renders. WAV and AIFF are read memory-mapped
+// where the platform allows. Files render in parallel, one processor per
+// thread, and each is printed with its throughput once done. Output is latency
+// compensated and keeps --tail seconds after the input ends (default: the
+// plugin's own tail).
+
+namespace
+{
+    struct Options
+    {
+        juce::File preset, outputDirectory;
+        int blockSize = 4096;
+        double tailSeconds = -1.0; // < 0: ask the processor
+    };
+
+    // A file to render and where its output goes, relative to --out
+    struct Input
+    {
+        juce::File file;
+        juce::String outputPath;
+    };
+
+    struct RenderStats
+    {
+        double audioSeconds = 0.0;
+        double processSeconds = 0.0;
+        juce::int64 bytesWritten = 0;
+    };
+
+    std::unique_ptr<juce::AudioFormatReader> openReader(juce::AudioFormatManager& formats, const juce::File& file)
+    {
+        // Memory mapping avoids a copy through the stream for uncompressed formats
+        if (auto* format = formats.findFormatForFileExtension(file.getFileExtension()))
+        {
+            if (std::unique_ptr<juce::MemoryMappedAudioFormatReader> mapped{ format->createMemoryMappedReader(file) })
+                if (mapped->mapEntireFile())
+                    return mapped;
+        }
+
+        return std::unique_ptr<juce::AudioFormatReader>(formats.createReaderFor(file));
+    }
+
+    std::unique_ptr<juce::AudioFormatWriter> openWriter(juce::AudioFormatManager& formats, const juce::File& file,
+                                                        const juce::AudioFormatReader& source)
+    {
+        auto* format = formats.findFormatForFileExtension(file.getFileExtension());
+        if (format == nullptr)
+            return {};
+
+        // Keep the source resolution where the format has it, else the nearest below
+        int bitsPerSample = 0;
+        for (auto depth : format->getPossibleBitDepths())
+            if (depth <= (int)source.bitsPerSample)
+                bitsPerSample = juce::jmax(bitsPerSample, depth);
+
+        if (bitsPerSample == 0)
+            bitsPerSample = format->getPossibleBitDepths()[0];
+
+        file.deleteFile();
+        std::unique_ptr<juce::OutputStream> stream(file.createOutputStream());
+        if (stream == nullptr)
+            return {};
+
+        std::unique_ptr<juce::AudioFormatWriter> writer(format->createWriterFor(
+            stream.get(), source.sampleRate, source.numChannels, bitsPerSample, source.metadataValues, 0));
+
+        if (writer != nullptr)
+            stream.release(); // now owned by the writer
+
+        return writer;
+    }
+
+    bool renderFile(DREKAVACAudioProcessor& processor, const Input& input, const Options& options,
+                    RenderStats& stats, juce::String& error)
+    {
+        juce::AudioFormatManager formats;
+        formats.registerBasicFormats();
+
+        auto reader = openReader(formats, input.file);
+        if (reader == nullptr)
+        {
+            error = "cannot read";
+            return false;
+        }
+
+        const auto numChannels = (int)reader->numChannels;
+        const auto sampleRate = reader->sampleRate;
+
+        if (numChannels < 1 || numChannels > 16)
+        {
+            error = juce::String(numChannels) + " channels not supported";
+            return false;
+        }
+
+        const auto output = options.outputDirectory.getChildFile(input.outputPath);
+        auto writer = openWriter(formats, output, *reader);
+        if (writer == nullptr)
+        {
+            error = "cannot write " + output.getFullPathName();
+            return false;
+        }
+
+        processor.setNonRealtime(true);
+        processor.setPlayConfigDetails(numChannels, numChannels, sampleRate, options.blockSize);
+        processor.prepareToPlay(sampleRate, options.blockSize);
+
+        // Latency is trimmed off the front, the tail is rendered past the end
+        const int latency = processor.getLatencySamples();
+        const auto tailSeconds = options.tailSeconds >= 0.0 ? options.tailSeconds + latency / sampleRate
+                                                            : processor.getTailLengthSeconds();
+        const auto inputLength = reader->lengthInSamples;
+        const auto totalLength = inputLength + juce::jmax((juce::int64)latency, (juce::int64)std::ceil(tailSeconds * sampleRate));
+
+        juce::AudioBuffer<float> block(numChannels, options.blockSize);
+        juce::MidiBuffer midi;
+        juce::int64 ticks = 0;
+        bool written = true;
+
+        for (juce::int64 position = 0; position < totalLength && written; position += options.blockSize)
+        {
+            const auto numSamples = (int)juce::jmin((juce::int64)options.blockSize, totalLength - position);
+            block.setSize(numChannels, numSamples, false, false, true);
+
+            // Past the end of the file the reader fills with silence
+            reader->read(&block, 0, numSamples, position, true, true);
+
+            const auto before = juce::Time::getHighResolutionTicks();
+            processor.processBlock(block, midi);
+            ticks += juce::Time::getHighResolutionTicks() - before;
+
+            const auto skip = (int)juce::jlimit((juce::int64)0, (juce::int64)numSamples, latency - position);
+            if (skip < numSamples)
+                written = writer->writeFromAudioSampleBuffer(block, skip, numSamples - skip);
+        }
+
+        processor.releaseResources();
+        writer.reset();
+
+        if (!written)
+        {
+            error = "write failed";
+            return false;
+        }
+
+        stats.audioSeconds = inputLength / sampleRate;
+        stats.processSeconds = juce::Time::highResolutionTicksToSeconds(ticks);
+        stats.bytesWritten = output.getSize();
+        return true;
+    }
+
+    std::vector<Input> collectInputs(const juce::ArgumentList& args)
+    {
+        std::vector<Input> inputs;
+        const juce::String wildcard = "*.wav;*.aif;*.aiff;*.flac";
+
+        for (const auto& arg : args.arguments)
+        {
+            if (arg.isOption())
+                continue;
+
+            const auto file = arg.resolveAsFile();
+            if (file.isDirectory())
+            {
+                for (const auto& child : file.findChildFiles(juce::File::findFiles, true, wildcard))
+                    inputs.push_back({ child, child.getRelativePathFrom(file) });
+            }
+            else if (file.existsAsFile())
+            {
+                inputs.push_back({ file, file.getFileName() });
+            }
+            else
+            {
+                std::cout << "MISSING " << file.getFullPathName() << "\n";
+            }
+        }
+
+        return inputs;
+    }
+
+    // Prints every input whose output another input already claims. Compared
+    // without case, since that is how the file system may see them.
+    bool hasClashingOutputs(const std::vector<Input>& inputs)
+    {
+        juce::StringArray outputPaths;
+        bool clash = false;
+
+        for (const auto& input : inputs)
+        {
+            if (outputPaths.contains(input.outputPath, true))
+            {
+                std::cout << "CLASH   " << input.file.getFullPathName() << " would overwrite another input's "
+                          << input.outputPath << "\n";
+                clash = true;
+            }
+
+            outputPaths.add(input.outputPath);
+        }
+
+        return clash;
+    }
+
+    juce::File resolveOption(const juce::ArgumentList& args, const char* option)
+    {
+        return juce::File::getCurrentWorkingDirectory().getChildFile(args.getValueForOption(option));
+    }
+}
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    juce::ArgumentList args(argc, argv);
+
+    if (!args.containsOption("--preset") || !args.containsOption("--out"))
+    {
+        std::cout << "usage: DREKAVACRender --preset=<file.preset> --out=<dir> [--threads=N] [--block=4096]"
+                     " [--tail=<seconds>] <file or folder>...\n";
+        return 1;
+    }
+
+    Options options;
+    options.preset = resolveOption(args, "--preset");
+    options.outputDirectory = resolveOption(args, "--out");
+
+    if (args.containsOption("--block"))
+        options.blockSize = juce::jlimit(16, 65536, args.getValueForOption("--block").getIntValue());
+
+    if (args.containsOption("--tail"))
+        options.tailSeconds = juce::jmax(0.0, args.getValueForOption("--tail").getDoubleValue());
+
+    if (!options.preset.existsAsFile())
+    {
+        std::cout << "Cannot open preset " << options.preset.getFullPathName() << "\n";
+        return 1;
+    }
+
+    if (!options.outputDirectory.createDirectory())
+    {
+        std::cout << "Cannot create " << options.outputDirectory.getFullPathName() << "\n";
+        return 1;
+    }
+
+    const auto inputs = collectInputs(args);
+    if (inputs.empty())
+    {
+        std::cout << "Nothing to render\n";
+        return 1;
+    }
+
+    if (hasClashingOutputs(inputs))
+        return 1;
+
+    // Subfolders are made here, before the jobs could race to create them
+    for (const auto& input : inputs)
+    {
+        const auto folder = options.outputDirectory.getChildFile(input.outputPath).getParentDirectory();
+        if (!folder.createDirectory())
+        {
+            std::cout << "Cannot create " << folder.getFullPathName() << "\n";
+            return 1;
+        }
+    }
+
+    const auto numThreads = juce::jlimit(1, (int)inputs.size(),
+                                         args.containsOption("--threads") ? args.getValueForOption("--threads").getIntValue()
+                                                                          : juce::SystemStats::getNumCpus());
+
+    // One processor per thread, built and given the preset here on the main thread.
+    // A job borrows a free one and hands it back when its file is done.
+    std::vector<std::unique_ptr<DREKAVACAudioProcessor>> processors;
+    juce::Array<DREKAVACAudioProcessor*> idleProcessors;
+
+    for (int i = 0; i < numThreads; ++i)
+    {
+        processors.push_back(std::make_unique<DREKAVACAudioProcessor>());
+        processors.back()->loadPresetFromFile(options.preset);
+        idleProcessors.add(processors.back().get());
+    }
+
+    juce::CriticalSection lock; // idleProcessors, totals and std::cout
+    RenderStats totals;
+    std::atomic<int> failures{ 0 };
+
+    const auto startTicks = juce::Time::getHighResolutionTicks();
+
+    {
+        juce::ThreadPool pool(numThreads);
+
+        for (const auto& input : inputs)
+        {
+            pool.addJob([&, input]
+                {
+                    DREKAVACAudioProcessor* processor = nullptr;
+                    {
+                        const juce::ScopedLock sl(lock);
+                        processor = idleProcessors.removeAndReturn(idleProcessors.size() - 1);
+                    }
+
+                    RenderStats stats;
+                    juce::String error;
+                    const bool ok = renderFile(*processor, input, options, stats, error);
+
+                    const juce::ScopedLock sl(lock);
+                    idleProcessors.add(processor);
+
+                    if (!ok)
+                    {
+                        ++failures;
+                        std::cout << "FAILED  " << input.outputPath << "  " << error << "\n";
+                        return;
+                    }
+
+                    totals.audioSeconds += stats.audioSeconds;
+                    totals.processSeconds += stats.processSeconds;
+                    totals.bytesWritten += stats.bytesWritten;
+
+                    std::cout << "ok      " << input.outputPath.paddedRight(' ', 40)
+                              << juce::String(stats.audioSeconds, 1).paddedLeft(' ', 9) << " s"
+                              << juce::String(stats.audioSeconds / juce::jmax(1.0e-9, stats.processSeconds), 1)
+                                     .paddedLeft(' ', 10) << " x realtime\n";
+                });
+        }
+
+        while (pool.getNumJobs() > 0)
+            juce::Thread::sleep(20);
+    }
+
+    const auto wallSeconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+
+    std::cout << "\n" << (int)inputs.size() - failures.load() << " of " << inputs.size() << " files, "
+              << juce::String(totals.audioSeconds, 1) << " s of audio in " << juce::String(wallSeconds, 2) << " s on "
+              << numThreads << " threads: " << juce::String(totals.audioSeconds / juce::jmax(1.0e-9, wallSeconds), 1)
+              << " x realtime, " << juce::String(totals.bytesWritten / (1024.0 * 1024.0) / juce::jmax(1.0e-9, wallSeconds), 1)
+              << " MB/s written\n";
+
+    return failures.load() == 0 ? 0 : 1;
+}